@@ -0,0 +1,188 @@
+#pragma once
+#include "CommonUtils/PropertyTree.hpp"
+#include <cstddef>
+#include <functional>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace ULCommonUtils
+{
+	inline std::pmr::memory_resource*& currentArenaSlot()
+	{
+		thread_local std::pmr::memory_resource* resource = std::pmr::new_delete_resource();
+		return resource;
+	}
+
+	//Memory resource the calling thread places new arena allocated containers, strings and nodes in
+	inline std::pmr::memory_resource* currentArena()
+	{
+		return currentArenaSlot();
+	}
+
+	//Installs a monotonic arena for the calling thread for as long as it lives, previously installed arenas are restored afterwards.
+	//Everything an ArenaPropertyTree allocates meanwhile (containers, keys, string values and tree nodes) is released in
+	//one step when the arena goes away, so those trees must not outlive it. Likewise a longer lived ArenaPropertyTree
+	//must not be grown while a shorter lived arena is installed, its new nodes would be placed in that arena.
+	class ScopedArena
+	{
+		std::pmr::monotonic_buffer_resource m_resource;
+		std::pmr::memory_resource* m_previous;
+
+		std::pmr::memory_resource* install()
+		{
+			auto previous = currentArenaSlot();
+			currentArenaSlot() = &m_resource;
+			return previous;
+		}
+
+	public:
+		ScopedArena() :
+			m_resource(),
+			m_previous(install())
+		{
+		}
+
+		explicit ScopedArena(size_t initialSize) :
+			m_resource(initialSize),
+			m_previous(install())
+		{
+		}
+
+		//Starts with a caller provided buffer, e.g. on the stack of a request handler
+		ScopedArena(void* buffer, size_t size) :
+			m_resource(buffer, size),
+			m_previous(install())
+		{
+		}
+
+		ScopedArena(const ScopedArena&) = delete;
+		ScopedArena& operator=(const ScopedArena&) = delete;
+
+		~ScopedArena()
+		{
+			currentArenaSlot() = m_previous;
+		}
+
+		std::pmr::memory_resource* resource()
+		{
+			return &m_resource;
+		}
+	};
+
+	//Allocator bound to the arena of the thread that created it. Copies of a container land in the arena current at the
+	//time of the copy, moves and swaps keep the memory where it is.
+	template<typename T>
+	class ArenaAllocator
+	{
+		std::pmr::memory_resource* m_resource;
+
+	public:
+		typedef T value_type;
+		typedef std::false_type propagate_on_container_copy_assignment;
+		typedef std::true_type propagate_on_container_move_assignment;
+		typedef std::true_type propagate_on_container_swap;
+
+		ArenaAllocator() noexcept :
+			m_resource(currentArena())
+		{
+		}
+
+		ArenaAllocator(std::pmr::memory_resource* resource) noexcept :
+			m_resource(resource)
+		{
+		}
+
+		template<typename U>
+		ArenaAllocator(const ArenaAllocator<U>& other) noexcept :
+			m_resource(other.resource())
+		{
+		}
+
+		T* allocate(size_t n)
+		{
+			return static_cast<T*>(m_resource->allocate(n * sizeof(T), alignof(T)));
+		}
+
+		void deallocate(T* ptr, size_t n)
+		{
+			m_resource->deallocate(ptr, n * sizeof(T), alignof(T));
+		}
+
+		ArenaAllocator select_on_container_copy_construction() const
+		{
+			return ArenaAllocator();
+		}
+
+		std::pmr::memory_resource* resource() const
+		{
+			return m_resource;
+		}
+
+		template<typename U>
+		bool operator==(const ArenaAllocator<U>& other) const
+		{
+			return (m_resource == other.resource()) || (*m_resource == *other.resource());
+		}
+
+		template<typename U>
+		bool operator!=(const ArenaAllocator<U>& other) const
+		{
+			return !(*this == other);
+		}
+	};
+
+	typedef std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>> ArenaString;
+}
+
+namespace std
+{
+	template<>
+	struct hash<ULCommonUtils::ArenaString>
+	{
+		size_t operator()(const ULCommonUtils::ArenaString& str) const noexcept
+		{
+			return std::hash<std::string_view>()(std::string_view(str.data(), str.length()));
+		}
+	};
+}
+
+namespace ULCommonUtils
+{
+	//Places containers in the current arena and routes the nodes boost::recursive_wrapper allocates to it as well
+	struct ArenaTreePolicy
+	{
+		template<typename Key, typename Value>
+		using Map = std::unordered_map<Key, Value, std::hash<Key>, std::equal_to<Key>, ArenaAllocator<std::pair<const Key, Value>>>;
+
+		template<typename Value>
+		using Vector = std::vector<Value, ArenaAllocator<Value>>;
+
+		//Every node remembers the resource it came from, so it may be freed after another arena has been installed
+		struct NodeBase
+		{
+			static constexpr size_t HeaderSize = alignof(std::max_align_t);
+
+			static void* operator new(size_t size)
+			{
+				auto resource = currentArena();
+				auto block = static_cast<char*>(resource->allocate(size + HeaderSize, alignof(std::max_align_t)));
+				*reinterpret_cast<std::pmr::memory_resource**>(block) = resource;
+				return block + HeaderSize;
+			}
+
+			static void operator delete(void* ptr, size_t size)
+			{
+				auto block = static_cast<char*>(ptr) - HeaderSize;
+				(*reinterpret_cast<std::pmr::memory_resource**>(block))->deallocate(block, size + HeaderSize, alignof(std::max_align_t));
+			}
+		};
+	};
+
+	//Per request document: parse with deseraliseFromJSon<ArenaPropertyTree>() while a ScopedArena is active,
+	//inspect, then let the tree and the arena go out of scope
+	typedef BasicPropertyTree<ArenaTreePolicy, ArenaString, ArenaString, char, int, long long, size_t, double> ArenaPropertyTree;
+}
@@ -0,0 +1,144 @@
+#pragma once
+#include "CommonUtils/PropertyTree.hpp"
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace ULCommonUtils
+{
+	//Process wide table of interned strings. Interned strings are never released, so the table is meant for the small
+	//and repetitive vocabulary of keys ("px", "qty", "side", ...), not for arbitrary values.
+	class AtomTable
+	{
+		std::deque<std::string> m_strings;	//Elements never move, the index refers into them
+		std::unordered_map<std::string_view, const std::string*> m_index;
+		mutable std::shared_mutex m_mutex;
+
+		AtomTable() {}
+
+	public:
+		AtomTable(const AtomTable&) = delete;
+		AtomTable& operator=(const AtomTable&) = delete;
+
+		static AtomTable& instance()
+		{
+			static AtomTable table;
+			return table;
+		}
+
+		const std::string* intern(std::string_view str)
+		{
+			{
+				std::shared_lock<std::shared_mutex> lock(m_mutex);
+				auto it = m_index.find(str);
+				if (it != m_index.end())
+					return it->second;
+			}
+
+			std::unique_lock<std::shared_mutex> lock(m_mutex);
+			auto it = m_index.find(str);
+			if (it != m_index.end())
+				return it->second;
+
+			const std::string* interned = &m_strings.emplace_back(str);
+			m_index.emplace(*interned, interned);
+			return interned;
+		}
+
+		size_t size() const
+		{
+			std::shared_lock<std::shared_mutex> lock(m_mutex);
+			return m_strings.size();
+		}
+	};
+
+	//Interned string: equal atoms share the same storage, so comparing and hashing them only looks at a pointer.
+	//Every thread keeps a cache of the atoms it has seen and only goes to the shared table for new strings.
+	//Keep atoms for frequently used keys around, e.g. `static const Atom px("px");`, constructing one from text always
+	//costs a lookup.
+	class Atom
+	{
+		const std::string* m_str;
+
+		static const std::string* intern(std::string_view str)
+		{
+			thread_local std::unordered_map<std::string_view, const std::string*> cache;
+			auto it = cache.find(str);
+			if (it != cache.end())
+				return it->second;
+
+			auto interned = AtomTable::instance().intern(str);
+			cache.emplace(*interned, interned);
+			return interned;
+		}
+
+	public:
+		Atom() : m_str(intern(std::string_view())) {}
+
+		Atom(std::string_view str) : m_str(intern(str)) {}
+
+		Atom(const char* str) : m_str(intern(str)) {}
+
+		Atom(const std::string& str) : m_str(intern(str)) {}
+
+		const std::string& str() const
+		{
+			return *m_str;
+		}
+
+		operator const std::string&() const
+		{
+			return *m_str;
+		}
+
+		operator std::string_view() const
+		{
+			return *m_str;
+		}
+
+		const void* id() const
+		{
+			return m_str;
+		}
+
+		bool operator==(const Atom& other) const
+		{
+			return (m_str == other.m_str);
+		}
+
+		bool operator!=(const Atom& other) const
+		{
+			return (m_str != other.m_str);
+		}
+
+		friend std::string operator+(const std::string& lhs, const Atom& rhs)
+		{
+			return lhs + *rhs.m_str;
+		}
+	};
+}
+
+namespace std
+{
+	template<>
+	struct hash<ULCommonUtils::Atom>
+	{
+		size_t operator()(const ULCommonUtils::Atom& atom) const noexcept
+		{
+			//Mix the pointer bits, the low ones are always zero
+			auto val = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(atom.id()));
+			return static_cast<size_t>((val ^ (val >> 29)) * 0x9e3779b97f4a7c15ULL);
+		}
+	};
+}
+
+namespace ULCommonUtils
+{
+	//JSon shaped tree with interned keys, the JSon reader interns every key it reads
+	typedef PropertyTree<Atom, std::string, char, int, long long, size_t, double> AtomPropertyTree;
+}
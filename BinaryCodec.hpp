@@ -0,0 +1,611 @@
+#pragma once
+#include "CommonUtils/PropertyTree.hpp"
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ULCommonUtils
+{
+	//Compact binary encoding of property trees, every value starts with a one byte type tag followed by:
+	//	Tree		u32 body length, u32 member count, per member u32 key length, key bytes and the encoded value
+	//	Array		u32 body length, u32 element count, the encoded elements
+	//	String		u32 length, bytes
+	//	Char		1 byte
+	//	Int			4 bytes two's complement
+	//	LongLong	8 bytes two's complement
+	//	Size		8 bytes unsigned
+	//	Double		8 bytes IEEE 754
+	//All integers are little endian. The body length of trees and arrays counts the bytes after the length field, so
+	//readers skip a container without looking into it. A message is one encoded tree.
+	enum class BinaryType : uint8_t
+	{
+		Tree = 1,
+		Array,
+		String,
+		Char,
+		Int,
+		LongLong,
+		Size,
+		Double
+	};
+
+	namespace
+	{
+		constexpr size_t BinaryContainerHeaderSize = 1 + 4 + 4;
+
+		template<typename Unsigned, typename Sink>
+		void appendLittleEndian(Sink& sink, Unsigned val)
+		{
+			char bytes[sizeof(Unsigned)];
+			for (size_t i = 0; i < sizeof(Unsigned); i++)
+				bytes[i] = static_cast<char>(static_cast<uint8_t>(val >> (8 * i)));
+
+			sink.append(bytes, sizeof(Unsigned));
+		}
+
+		template<typename Unsigned>
+		Unsigned readLittleEndian(const char* data)
+		{
+			Unsigned val = 0;
+			for (size_t i = 0; i < sizeof(Unsigned); i++)
+				val |= static_cast<Unsigned>(static_cast<uint8_t>(data[i])) << (8 * i);
+
+			return val;
+		}
+
+		[[noreturn]] inline void throwMalformedBinary(const char* reason)
+		{
+			throw std::runtime_error(std::string("Malformed binary message, ") + reason);
+		}
+
+		inline uint32_t checkedLength(size_t length)
+		{
+			if (length > std::numeric_limits<uint32_t>::max())
+				throw std::runtime_error("Value too large for the binary encoding: " + std::to_string(length) + " bytes");
+
+			return static_cast<uint32_t>(length);
+		}
+
+		template<typename>
+		struct UnsupportedBinaryType : std::false_type {};
+
+		//First pass of the writer: the body length of every tree and array in the order the writer meets them
+		template<typename PropertyTree>
+		struct BinarySizer : boost::static_visitor<size_t>
+		{
+			typedef typename PropertyTree::Nodes Nodes;
+
+			BinarySizer(std::vector<uint32_t>& lengths) : m_lengths(lengths) {}
+
+			template<typename Traits, typename Allocator>
+			size_t operator()(const std::basic_string<char, Traits, Allocator>& str) const
+			{
+				return 1 + 4 + checkedLength(str.length());
+			}
+
+			size_t operator()(char) const
+			{
+				return 1 + 1;
+			}
+
+			size_t operator()(int) const
+			{
+				return 1 + 4;
+			}
+
+			size_t operator()(long long) const
+			{
+				return 1 + 8;
+			}
+
+			size_t operator()(size_t) const
+			{
+				return 1 + 8;
+			}
+
+			size_t operator()(double) const
+			{
+				return 1 + 8;
+			}
+
+			size_t operator()(const PropertyTree& pt) const
+			{
+				auto index = m_lengths.size();
+				m_lengths.push_back(0);
+
+				size_t body = 4;
+				for (auto it = pt.begin(); it != pt.end(); it++)
+					body += 4 + checkedLength(std::string_view(it->first).length()) + visitNode(*this, it->second);
+
+				m_lengths[index] = checkedLength(body);
+				return 1 + 4 + body;
+			}
+
+			size_t operator()(const Nodes& nodes) const
+			{
+				auto index = m_lengths.size();
+				m_lengths.push_back(0);
+
+				size_t body = 4;
+				for (auto it = nodes.begin(); it != nodes.end(); it++)
+					body += visitNode(*this, *it);
+
+				m_lengths[index] = checkedLength(body);
+				return 1 + 4 + body;
+			}
+
+			template<typename Value>
+			size_t operator()(const Value&) const
+			{
+				static_assert(UnsupportedBinaryType<Value>::value, "The binary encoding covers strings, char, int, long long, size_t and double values only");
+				return 0;
+			}
+
+		private:
+			std::vector<uint32_t>& m_lengths;
+		};
+
+		template<typename Sink, typename PropertyTree>
+		struct BinaryWriter : boost::static_visitor<void>
+		{
+			typedef typename PropertyTree::Nodes Nodes;
+
+			BinaryWriter(Sink& sink, const std::vector<uint32_t>& lengths) :
+				m_sink(sink),
+				m_lengths(lengths),
+				m_next(0)
+			{
+			}
+
+			template<typename Traits, typename Allocator>
+			void operator()(const std::basic_string<char, Traits, Allocator>& str)
+			{
+				m_sink.append(static_cast<char>(BinaryType::String));
+				appendLittleEndian(m_sink, static_cast<uint32_t>(str.length()));
+				m_sink.append(str.data(), str.length());
+			}
+
+			void operator()(char ch)
+			{
+				m_sink.append(static_cast<char>(BinaryType::Char));
+				m_sink.append(ch);
+			}
+
+			void operator()(int num)
+			{
+				m_sink.append(static_cast<char>(BinaryType::Int));
+				appendLittleEndian(m_sink, static_cast<uint32_t>(num));
+			}
+
+			void operator()(long long num)
+			{
+				m_sink.append(static_cast<char>(BinaryType::LongLong));
+				appendLittleEndian(m_sink, static_cast<uint64_t>(num));
+			}
+
+			void operator()(size_t num)
+			{
+				m_sink.append(static_cast<char>(BinaryType::Size));
+				appendLittleEndian(m_sink, static_cast<uint64_t>(num));
+			}
+
+			void operator()(double num)
+			{
+				uint64_t bits;
+				std::memcpy(&bits, &num, sizeof(bits));
+				m_sink.append(static_cast<char>(BinaryType::Double));
+				appendLittleEndian(m_sink, bits);
+			}
+
+			void operator()(const PropertyTree& pt)
+			{
+				m_sink.append(static_cast<char>(BinaryType::Tree));
+				appendLittleEndian(m_sink, m_lengths[m_next++]);
+				appendLittleEndian(m_sink, static_cast<uint32_t>(pt.size()));
+				for (auto it = pt.begin(); it != pt.end(); it++)
+				{
+					std::string_view key(it->first);
+					appendLittleEndian(m_sink, static_cast<uint32_t>(key.length()));
+					m_sink.append(key.data(), key.length());
+					visitNode(*this, it->second);
+				}
+			}
+
+			void operator()(const Nodes& nodes)
+			{
+				m_sink.append(static_cast<char>(BinaryType::Array));
+				appendLittleEndian(m_sink, m_lengths[m_next++]);
+				appendLittleEndian(m_sink, static_cast<uint32_t>(nodes.size()));
+				for (auto it = nodes.begin(); it != nodes.end(); it++)
+					visitNode(*this, *it);
+			}
+
+		private:
+			Sink& m_sink;
+			const std::vector<uint32_t>& m_lengths;
+			size_t m_next;
+		};
+	}
+
+	class BinaryValue;
+
+	//Forward iterator over the members of an encoded tree, yields the key and the value
+	class BinaryMemberIterator
+	{
+		const char* m_pos;
+		const char* m_end;
+		size_t m_remaining;
+
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef std::pair<std::string_view, BinaryValue> value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const value_type* pointer;
+		typedef value_type reference;
+
+		BinaryMemberIterator(const char* pos, const char* end, size_t remaining) :
+			m_pos(pos),
+			m_end(end),
+			m_remaining(remaining)
+		{
+		}
+
+		value_type operator*() const;
+
+		BinaryMemberIterator& operator++();
+
+		bool operator==(const BinaryMemberIterator& other) const
+		{
+			return (m_remaining == other.m_remaining);
+		}
+
+		bool operator!=(const BinaryMemberIterator& other) const
+		{
+			return (m_remaining != other.m_remaining);
+		}
+	};
+
+	//Forward iterator over the elements of an encoded array
+	class BinaryElementIterator
+	{
+		const char* m_pos;
+		const char* m_end;
+		size_t m_remaining;
+
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef BinaryValue value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const BinaryValue* pointer;
+		typedef BinaryValue reference;
+
+		BinaryElementIterator(const char* pos, const char* end, size_t remaining) :
+			m_pos(pos),
+			m_end(end),
+			m_remaining(remaining)
+		{
+		}
+
+		BinaryValue operator*() const;
+
+		BinaryElementIterator& operator++();
+
+		bool operator==(const BinaryElementIterator& other) const
+		{
+			return (m_remaining == other.m_remaining);
+		}
+
+		bool operator!=(const BinaryElementIterator& other) const
+		{
+			return (m_remaining != other.m_remaining);
+		}
+	};
+
+	template<typename Iterator>
+	class BinaryRange
+	{
+		Iterator m_begin;
+		Iterator m_end;
+
+	public:
+		BinaryRange(Iterator begin, Iterator end) : m_begin(begin), m_end(end) {}
+
+		Iterator begin() const
+		{
+			return m_begin;
+		}
+
+		Iterator end() const
+		{
+			return m_end;
+		}
+	};
+
+	//Read only view of one encoded value, strings are returned as views into the encoded buffer which has to outlive the view.
+	//Nothing is decoded up front: finding a member or an element walks the container skipping the values in between.
+	//Accessors for a different type than the encoded one and values running past their container throw std::runtime_error.
+	class BinaryValue
+	{
+		const char* m_data;
+		const char* m_end;	//End of the enclosing container
+
+		void expectType(BinaryType type) const
+		{
+			if (type != this->type())
+				throw std::runtime_error("Binary value holds another type");
+		}
+
+		const char* payload(size_t length) const
+		{
+			if (static_cast<size_t>(m_end - m_data) < 1 + length)
+				throwMalformedBinary("value runs past its container");
+
+			return m_data + 1;
+		}
+
+		const char* containerBody() const
+		{
+			auto header = payload(8);
+			if (static_cast<size_t>(m_end - header) < 4 + static_cast<size_t>(readLittleEndian<uint32_t>(header)))
+				throwMalformedBinary("container runs past its parent");
+
+			return header + 4;
+		}
+
+		const char* containerEnd() const
+		{
+			return payload(4) + 4 + readLittleEndian<uint32_t>(m_data + 1);
+		}
+
+	public:
+		BinaryValue(const char* data, const char* end) :
+			m_data(data),
+			m_end(end)
+		{
+			if (m_data >= m_end)
+				throwMalformedBinary("unexpected end of input");
+			else if ((static_cast<uint8_t>(*m_data) < static_cast<uint8_t>(BinaryType::Tree)) || (static_cast<uint8_t>(*m_data) > static_cast<uint8_t>(BinaryType::Double)))
+				throwMalformedBinary("unknown type tag");
+		}
+
+		BinaryType type() const
+		{
+			return static_cast<BinaryType>(*m_data);
+		}
+
+		//Bytes taken by the encoded value including its tag
+		size_t encodedSize() const
+		{
+			switch (type())
+			{
+			case BinaryType::Tree:
+			case BinaryType::Array:
+				containerBody();
+				return 1 + 4 + readLittleEndian<uint32_t>(m_data + 1);
+			case BinaryType::String:
+				return 1 + 4 + readLittleEndian<uint32_t>(payload(4));
+			case BinaryType::Char:
+				return 1 + 1;
+			case BinaryType::Int:
+				return 1 + 4;
+			default:
+				return 1 + 8;
+			}
+		}
+
+		std::string_view asString() const
+		{
+			expectType(BinaryType::String);
+			auto length = readLittleEndian<uint32_t>(payload(4));
+			return std::string_view(payload(4 + length) + 4, length);
+		}
+
+		char asChar() const
+		{
+			expectType(BinaryType::Char);
+			return *payload(1);
+		}
+
+		int asInt() const
+		{
+			expectType(BinaryType::Int);
+			return static_cast<int>(static_cast<int32_t>(readLittleEndian<uint32_t>(payload(4))));
+		}
+
+		long long asLongLong() const
+		{
+			expectType(BinaryType::LongLong);
+			return static_cast<long long>(static_cast<int64_t>(readLittleEndian<uint64_t>(payload(8))));
+		}
+
+		size_t asSize() const
+		{
+			expectType(BinaryType::Size);
+			return static_cast<size_t>(readLittleEndian<uint64_t>(payload(8)));
+		}
+
+		double asDouble() const
+		{
+			expectType(BinaryType::Double);
+			auto bits = readLittleEndian<uint64_t>(payload(8));
+			double num;
+			std::memcpy(&num, &bits, sizeof(num));
+			return num;
+		}
+
+		//Members of a tree or elements of an array
+		size_t size() const
+		{
+			if ((BinaryType::Tree != type()) && (BinaryType::Array != type()))
+				throw std::runtime_error("Binary value holds another type");
+
+			return readLittleEndian<uint32_t>(containerBody());
+		}
+
+		BinaryRange<BinaryMemberIterator> members() const
+		{
+			expectType(BinaryType::Tree);
+			auto body = containerBody();
+			return { BinaryMemberIterator(body + 4, containerEnd(), readLittleEndian<uint32_t>(body)), BinaryMemberIterator(nullptr, nullptr, 0) };
+		}
+
+		BinaryRange<BinaryElementIterator> elements() const
+		{
+			expectType(BinaryType::Array);
+			auto body = containerBody();
+			return { BinaryElementIterator(body + 4, containerEnd(), readLittleEndian<uint32_t>(body)), BinaryElementIterator(nullptr, nullptr, 0) };
+		}
+
+		std::optional<BinaryValue> find(std::string_view key) const
+		{
+			for (auto member : members())
+			{
+				if (member.first == key)
+					return member.second;
+			}
+
+			return std::nullopt;
+		}
+
+		BinaryValue operator[](size_t index) const
+		{
+			if (index >= size())
+				throw std::runtime_error("Binary array index out of range: " + std::to_string(index));
+
+			auto it = elements().begin();
+			std::advance(it, index);
+			return *it;
+		}
+	};
+
+	inline BinaryMemberIterator::value_type BinaryMemberIterator::operator*() const
+	{
+		if (static_cast<size_t>(m_end - m_pos) < 4)
+			throwMalformedBinary("member runs past its tree");
+
+		auto length = readLittleEndian<uint32_t>(m_pos);
+		if (static_cast<size_t>(m_end - m_pos) < 4 + static_cast<size_t>(length))
+			throwMalformedBinary("key runs past its tree");
+
+		return { std::string_view(m_pos + 4, length), BinaryValue(m_pos + 4 + length, m_end) };
+	}
+
+	inline BinaryMemberIterator& BinaryMemberIterator::operator++()
+	{
+		auto member = **this;
+		m_pos = member.first.data() + member.first.length() + member.second.encodedSize();
+		m_remaining--;
+		return *this;
+	}
+
+	inline BinaryValue BinaryElementIterator::operator*() const
+	{
+		return BinaryValue(m_pos, m_end);
+	}
+
+	inline BinaryElementIterator& BinaryElementIterator::operator++()
+	{
+		m_pos += BinaryValue(m_pos, m_end).encodedSize();
+		m_remaining--;
+		return *this;
+	}
+
+	//View of the tree a message encodes, the buffer has to outlive the view
+	inline BinaryValue binaryRoot(std::string_view message)
+	{
+		BinaryValue root(message.data(), message.data() + message.length());
+		if (BinaryType::Tree != root.type())
+			throwMalformedBinary("a message has to encode a tree");
+
+		return root;
+	}
+
+	namespace
+	{
+		template<typename Tree>
+		void decodeBinaryValue(const BinaryValue& value, typename Tree::Node& val);
+
+		template<typename Tree>
+		void decodeBinaryObject(const BinaryValue& value, Tree& pt)
+		{
+			for (auto member : value.members())
+				decodeBinaryValue<Tree>(member.second, pt.try_emplace(typename Tree::NodeContainer::key_type(member.first), 0).first->second);
+		}
+
+		template<typename Tree>
+		void decodeBinaryValues(const BinaryValue& value, typename Tree::Nodes& nodes)
+		{
+			for (auto element : value.elements())
+				decodeBinaryValue<Tree>(element, nodes.emplace_back(0));
+		}
+
+		template<typename Tree>
+		void decodeBinaryValue(const BinaryValue& value, typename Tree::Node& val)
+		{
+			switch (value.type())
+			{
+			case BinaryType::Tree:
+				val = Tree();
+				decodeBinaryObject(value, getValue<Tree>(val));
+				break;
+			case BinaryType::Array:
+				val = typename Tree::Nodes();
+				decodeBinaryValues<Tree>(value, getValue<typename Tree::Nodes>(val));
+				break;
+			case BinaryType::String:
+				val = typename JSonStringType<Tree>::type(value.asString());
+				break;
+			case BinaryType::Char:
+				val = value.asChar();
+				break;
+			case BinaryType::Int:
+				val = value.asInt();
+				break;
+			case BinaryType::LongLong:
+				val = value.asLongLong();
+				break;
+			case BinaryType::Size:
+				val = value.asSize();
+				break;
+			case BinaryType::Double:
+				val = value.asDouble();
+				break;
+			}
+		}
+	}
+
+	//Unlike JSon every scalar keeps its exact type, e.g. a size_t of 5 reads back as size_t and not as int
+	template<typename Sink, typename Policy, typename KeyType, typename T, typename... Args>
+	void serializeToBinary(const BasicPropertyTree<Policy, KeyType, T, Args...>& pt, Sink&& sink)
+	{
+		typedef BasicPropertyTree<Policy, KeyType, T, Args...> Tree;
+		std::vector<uint32_t> lengths;
+		BinarySizer<Tree> sizer(lengths);
+		sizer(pt);
+
+		BinaryWriter<std::remove_reference_t<Sink>, Tree> writer(sink, lengths);
+		writer(pt);
+	}
+
+	template<typename Policy, typename KeyType, typename T, typename... Args>
+	std::string serializeToBinary(const BasicPropertyTree<Policy, KeyType, T, Args...>& pt)
+	{
+		std::string str;
+		serializeToBinary(pt, StringSink(str));
+		return str;
+	}
+
+	//Tree may be any BasicPropertyTree<Policy, KeyType, String, char, int, long long, size_t, double>
+	template<typename Tree = JSonPropertyTree>
+	Tree deseraliseFromBinary(std::string_view message)
+	{
+		Tree pt;
+		decodeBinaryObject(binaryRoot(message), pt);
+		return pt;
+	}
+}
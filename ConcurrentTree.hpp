@@ -0,0 +1,227 @@
+#pragma once
+#include "CommonUtils/CommonDefs.hpp"
+#include "CommonUtils/PropertyTree.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ULCommonUtils
+{
+	//Current version of a tree read by many threads and replaced now and then by others, RCU style. Versions are
+	//immutable once published: a writer builds the next version aside and swaps it in, readers see either the old or
+	//the new version as a whole. Reading is wait free, it takes two loads and a store on a cache line owned by the
+	//reader. Replaced versions are reclaimed by epochs, once no reader may still be looking at them.
+	//	ConcurrentTree<> config(deseraliseFromJSon(json));
+	//	auto reader = config.reader();						//Once per reading thread
+	//	{
+	//		auto snapshot = reader.read();
+	//		snapshot->try_get<int>(path);
+	//	}
+	//	config.update([](JSonPropertyTree& pt) { pt["timeout"] = 30; });
+	//With a PersistentPropertyTree the copy made by update() shares every subtree the update does not touch.
+	template<typename Tree = JSonPropertyTree>
+	class ConcurrentTree
+	{
+		//On a cache line of its own so that readers do not slow each other down
+		struct alignas(64) ReaderSlot
+		{
+			std::atomic<uint64_t> m_epoch;	//Epoch in which the reader started reading, 0 while it does not read
+			size_t m_depth;					//Snapshots held by the reader, only touched by its thread
+			bool m_inUse;					//Guarded by m_mutex
+
+			ReaderSlot() : m_epoch(0), m_depth(0), m_inUse(true) {}
+		};
+
+		struct RetiredVersion
+		{
+			const Tree* m_tree;
+			uint64_t m_epoch;				//First epoch in which readers cannot see m_tree any more
+		};
+
+		std::atomic<const Tree*> m_current;
+		std::atomic<uint64_t> m_epoch;
+		stdMutex m_mutex;					//Serialises writers, reader registration and reclamation
+		std::vector<std::unique_ptr<ReaderSlot>> m_slots;
+		std::vector<RetiredVersion> m_retired;
+
+		//A reader announcing an epoch at least that of a retired version loaded the current version after the
+		//version was replaced, so the version can go once every reader is idle or has moved past its epoch
+		void reclaimLocked()
+		{
+			uint64_t oldest = UINT64_MAX;
+			for (auto& slot : m_slots)
+			{
+				uint64_t epoch = slot->m_epoch.load();
+				if (0 != epoch)
+					oldest = std::min(oldest, epoch);
+			}
+
+			size_t kept = 0;
+			for (auto& retired : m_retired)
+			{
+				if (retired.m_epoch <= oldest)
+					delete retired.m_tree;
+				else
+					m_retired[kept++] = retired;
+			}
+
+			m_retired.resize(kept);
+		}
+
+		void publishLocked(const Tree* next)
+		{
+			auto previous = m_current.exchange(next);
+			m_retired.push_back({ previous, m_epoch.fetch_add(1) + 1 });
+			reclaimLocked();
+		}
+
+	public:
+		//Consistent view of one version, valid while the snapshot lives
+		class Snapshot
+		{
+			friend class ConcurrentTree;
+
+			ReaderSlot* m_slot;
+			const Tree* m_tree;
+
+			Snapshot(ReaderSlot* slot, const Tree* tree) : m_slot(slot), m_tree(tree) {}
+
+		public:
+			Snapshot(Snapshot&& other) noexcept : m_slot(other.m_slot), m_tree(other.m_tree)
+			{
+				other.m_slot = nullptr;
+			}
+
+			Snapshot(const Snapshot&) = delete;
+			Snapshot& operator=(const Snapshot&) = delete;
+
+			~Snapshot()
+			{
+				if ((nullptr != m_slot) && (0 == --m_slot->m_depth))
+					m_slot->m_epoch.store(0, std::memory_order_release);
+			}
+
+			const Tree& operator*() const
+			{
+				return *m_tree;
+			}
+
+			const Tree* operator->() const
+			{
+				return m_tree;
+			}
+
+			const Tree& get() const
+			{
+				return *m_tree;
+			}
+		};
+
+		//Registration of one reading thread. A reader is used by one thread at a time and may hold several snapshots,
+		//all of them keep their versions alive until the last one is gone.
+		class Reader
+		{
+			friend class ConcurrentTree;
+
+			ConcurrentTree* m_owner;
+			ReaderSlot* m_slot;
+
+			Reader(ConcurrentTree* owner, ReaderSlot* slot) : m_owner(owner), m_slot(slot) {}
+
+		public:
+			Reader(Reader&& other) noexcept : m_owner(other.m_owner), m_slot(other.m_slot)
+			{
+				other.m_slot = nullptr;
+			}
+
+			Reader(const Reader&) = delete;
+			Reader& operator=(const Reader&) = delete;
+
+			~Reader()
+			{
+				if (nullptr != m_slot)
+				{
+					stdUniqueLock lock(m_owner->m_mutex);
+					m_slot->m_inUse = false;
+				}
+			}
+
+			Snapshot read()
+			{
+				if (0 == m_slot->m_depth++)
+					m_slot->m_epoch.store(m_owner->m_epoch.load());
+
+				return Snapshot(m_slot, m_owner->m_current.load());
+			}
+		};
+
+		explicit ConcurrentTree(Tree tree = Tree()) :
+			m_current(new Tree(std::move(tree))),
+			m_epoch(1)
+		{
+		}
+
+		ConcurrentTree(const ConcurrentTree&) = delete;
+		ConcurrentTree& operator=(const ConcurrentTree&) = delete;
+
+		//Every reader has to be gone
+		~ConcurrentTree()
+		{
+			for (auto& retired : m_retired)
+				delete retired.m_tree;
+
+			delete m_current.load();
+		}
+
+		Reader reader()
+		{
+			stdUniqueLock lock(m_mutex);
+			for (auto& slot : m_slots)
+			{
+				if (!slot->m_inUse)
+				{
+					slot->m_inUse = true;
+					return Reader(this, slot.get());
+				}
+			}
+
+			m_slots.push_back(std::make_unique<ReaderSlot>());
+			return Reader(this, m_slots.back().get());
+		}
+
+		//Replaces the current version
+		void publish(Tree tree)
+		{
+			auto next = new Tree(std::move(tree));
+			stdUniqueLock lock(m_mutex);
+			publishLocked(next);
+		}
+
+		//Publishes a copy of the current version changed by update(Tree&), atomically with respect to other writers.
+		//Nothing is published if update throws.
+		template<typename Update>
+		void update(Update&& update)
+		{
+			stdUniqueLock lock(m_mutex);
+			std::unique_ptr<Tree> next(new Tree(*m_current.load()));
+			update(*next);
+			publishLocked(next.release());
+		}
+
+		//Frees the replaced versions no reader can see any more, which publishing does as well
+		void reclaim()
+		{
+			stdUniqueLock lock(m_mutex);
+			reclaimLocked();
+		}
+
+		//Replaced versions still waiting for readers
+		size_t retiredVersions()
+		{
+			stdUniqueLock lock(m_mutex);
+			return m_retired.size();
+		}
+	};
+}
@@ -0,0 +1,394 @@
+#pragma once
+#include "CommonUtils/PropertyTree.hpp"
+#include <array>
+#include <charconv>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ULCommonUtils
+{
+	//One member of a bound struct and the key it is stored under
+	template<typename Struct, typename Member>
+	struct JSonField
+	{
+		typedef Member Type;
+
+		std::string_view m_name;
+		Member Struct::* m_member;
+	};
+
+	template<typename Struct, typename Member>
+	constexpr JSonField<Struct, Member> jsonField(std::string_view name, Member Struct::* member)
+	{
+		return { name, member };
+	}
+
+	//Field of a struct stored under the name of the member
+#define UL_JSON_FIELD(Struct, member) ULCommonUtils::jsonField(#member, &Struct::member)
+
+	//Declares the fields of a struct, which can then be read from and written to JSon without going through a tree:
+	//	template<>
+	//	struct JSonBinding<Order>
+	//	{
+	//		static constexpr auto fields = std::make_tuple(UL_JSON_FIELD(Order, id), jsonField("price", &Order::px));
+	//	};
+	//Members may be strings, chars, numbers, vectors, optionals (left out while empty), other bound structs and trees.
+	//Optionals can only be members, not elements of vectors or optionals, as JSon has no way to hold an empty one there.
+	//Every member but the optional ones has to be present when reading, absent optionals are reset, unknown keys are skipped.
+	template<typename Struct>
+	struct JSonBinding;
+
+	template<typename Struct, typename = void>
+	struct IsJSonBound : std::false_type {};
+
+	template<typename Struct>
+	struct IsJSonBound<Struct, std::void_t<decltype(JSonBinding<Struct>::fields)>> : std::true_type {};
+
+	//Reads and writes one type of value, specialise it to bind types of your own
+	template<typename Value, typename = void>
+	struct JSonCodec;
+
+	namespace
+	{
+		template<typename Value>
+		struct IsOptional : std::false_type {};
+
+		template<typename Value>
+		struct IsOptional<std::optional<Value>> : std::true_type {};
+	}
+
+	template<typename Traits, typename Allocator>
+	struct JSonCodec<std::basic_string<char, Traits, Allocator>>
+	{
+		typedef std::basic_string<char, Traits, Allocator> String;
+
+		//Escape sequences are kept as they are, as in trees
+		static void read(std::string_view json, size_t& start, String& val)
+		{
+			if ('\"' != peekToken(json, start))
+				throwMalformedJSon(json, start);
+
+			auto str = parseString(json, start);
+			val.assign(str.data(), str.length());
+		}
+
+		template<typename Sink>
+		static void write(Sink& sink, const String& val)
+		{
+			sink.append('\"');
+			sink.append(val.data(), val.length());
+			sink.append('\"');
+		}
+	};
+
+	template<>
+	struct JSonCodec<char>
+	{
+		static void read(std::string_view json, size_t& start, char& val)
+		{
+			if ('\'' != peekToken(json, start))
+				throwMalformedJSon(json, start);
+
+			val = parseChar(json, start);
+		}
+
+		template<typename Sink>
+		static void write(Sink& sink, char val)
+		{
+			sink.append('\'');
+			sink.append(val);
+			sink.append('\'');
+		}
+	};
+
+	//Integral members only take integers in their range, floating point members take any number
+	template<typename Number>
+	struct JSonCodec<Number, std::enable_if_t<std::is_arithmetic_v<Number> && !std::is_same_v<Number, char> && !std::is_same_v<Number, bool>>>
+	{
+		static void read(std::string_view json, size_t& start, Number& val)
+		{
+			peekToken(json, start);
+			size_t begin = start;
+			bool isFloating;
+			auto num = scanNumber(json, start, isFloating);
+			if (std::is_integral_v<Number> && isFloating)
+				throwMalformedJSon(json, begin);
+
+			if constexpr (std::is_integral_v<Number>)
+			{
+				if (std::from_chars(num.data(), num.data() + num.length(), val).ec != std::errc())
+					throw std::runtime_error(std::string("Number out of range: ") + std::string(num));
+			}
+			else
+			{
+				double parsed;
+				if (std::from_chars(num.data(), num.data() + num.length(), parsed).ec != std::errc())
+					throw std::runtime_error(std::string("Number out of range: ") + std::string(num));
+
+				val = static_cast<Number>(parsed);
+			}
+		}
+
+		template<typename Sink>
+		static void write(Sink& sink, Number val)
+		{
+			char buffer[32];
+			sink.append(buffer, formatJSonNumber(buffer, val));
+		}
+	};
+
+	template<typename Value, typename Allocator>
+	struct JSonCodec<std::vector<Value, Allocator>>
+	{
+		static_assert(!IsOptional<Value>::value, "Optionals can only be members of bound structs");
+
+		static void read(std::string_view json, size_t& start, std::vector<Value, Allocator>& val)
+		{
+			val.clear();
+			consumeToken(json, start, '[');
+			if (peekToken(json, start) == ']')
+			{
+				start++;
+				return;
+			}
+
+			while (true)
+			{
+				val.emplace_back();
+				JSonCodec<Value>::read(json, start, val.back());
+				char currentChar = peekToken(json, start);
+				start++;
+				if (']' == currentChar)
+					break;
+				else if (',' != currentChar)
+					throwMalformedJSon(json, start - 1);
+			}
+		}
+
+		template<typename Sink>
+		static void write(Sink& sink, const std::vector<Value, Allocator>& val)
+		{
+			sink.append('[');
+			for (size_t i = 0; i < val.size(); i++)
+			{
+				if (0 != i)
+					sink.append(',');
+
+				JSonCodec<Value>::write(sink, val[i]);
+			}
+
+			sink.append(']');
+		}
+	};
+
+	//Empty optionals are left out of the object holding them, only values are written here
+	template<typename Value>
+	struct JSonCodec<std::optional<Value>>
+	{
+		static_assert(!IsOptional<Value>::value, "Optionals can only be members of bound structs");
+
+		static void read(std::string_view json, size_t& start, std::optional<Value>& val)
+		{
+			val.emplace();
+			JSonCodec<Value>::read(json, start, *val);
+		}
+
+		template<typename Sink>
+		static void write(Sink& sink, const std::optional<Value>& val)
+		{
+			JSonCodec<Value>::write(sink, *val);
+		}
+	};
+
+	//Trees hold the parts of a message without a fixed schema
+	template<typename Policy, typename KeyType, typename T, typename... Args>
+	struct JSonCodec<BasicPropertyTree<Policy, KeyType, T, Args...>>
+	{
+		typedef BasicPropertyTree<Policy, KeyType, T, Args...> Tree;
+
+		static void read(std::string_view json, size_t& start, Tree& val)
+		{
+			val.clear();
+			parseObject(json, start, val);
+		}
+
+		template<typename Sink>
+		static void write(Sink& sink, const Tree& val)
+		{
+			serializeToJSon<NullVisitor>(val, sink);
+		}
+	};
+
+	namespace
+	{
+		template<typename Struct, size_t... I>
+		constexpr std::array<std::string_view, sizeof...(I)> jsonFieldNames(std::index_sequence<I...>)
+		{
+			return { std::get<I>(JSonBinding<Struct>::fields).m_name... };
+		}
+
+		template<typename Struct>
+		struct JSonFieldTable
+		{
+			static constexpr size_t Size = std::tuple_size_v<std::decay_t<decltype(JSonBinding<Struct>::fields)>>;
+			static constexpr std::array<std::string_view, Size> Names = jsonFieldNames<Struct>(std::make_index_sequence<Size>());
+
+			//Members usually come in the order they were declared in, the one after the last match is tried first
+			static size_t find(std::string_view key, size_t hint)
+			{
+				if ((hint < Size) && (Names[hint] == key))
+					return hint;
+
+				for (size_t i = 0; i < Size; i++)
+				{
+					if (Names[i] == key)
+						return i;
+				}
+
+				return Size;
+			}
+		};
+
+		template<typename Struct, size_t... I>
+		void readJSonField(std::string_view json, size_t& start, Struct& val, size_t index, std::index_sequence<I...>)
+		{
+			auto& fields = JSonBinding<Struct>::fields;
+			((index == I ? JSonCodec<typename std::decay_t<decltype(std::get<I>(fields))>::Type>::read(json, start, val.*(std::get<I>(fields).m_member)) : void()), ...);
+		}
+
+		//Absent optional members are reset, so that reading into a struct read before leaves nothing of the old message
+		template<typename Struct, size_t... I>
+		void checkJSonFields(Struct& val, const bool* present, std::index_sequence<I...>)
+		{
+			auto& fields = JSonBinding<Struct>::fields;
+			auto check = [](bool isPresent, std::string_view name, auto& member)
+			{
+				if (isPresent)
+					return;
+
+				if constexpr (IsOptional<std::decay_t<decltype(member)>>::value)
+					member.reset();
+				else
+					throw std::runtime_error(std::string("Member absent: ") + std::string(name));
+			};
+
+			(check(present[I], std::get<I>(fields).m_name, val.*(std::get<I>(fields).m_member)), ...);
+		}
+
+		template<typename Sink, typename Struct, size_t... I>
+		void writeJSonFields(Sink& sink, const Struct& val, std::index_sequence<I...>)
+		{
+			auto& fields = JSonBinding<Struct>::fields;
+			bool first = true;
+			auto write = [&sink, &first](std::string_view name, const auto& member)
+			{
+				if constexpr (IsOptional<std::decay_t<decltype(member)>>::value)
+				{
+					if (!member)
+						return;
+				}
+
+				if (!first)
+					sink.append(',');
+
+				first = false;
+				sink.append('\"');
+				sink.append(name.data(), name.length());
+				sink.append("\":", 2);
+				JSonCodec<std::decay_t<decltype(member)>>::write(sink, member);
+			};
+
+			(write(std::get<I>(fields).m_name, val.*(std::get<I>(fields).m_member)), ...);
+		}
+	}
+
+	template<typename Struct>
+	struct JSonCodec<Struct, std::enable_if_t<IsJSonBound<Struct>::value>>
+	{
+		typedef JSonFieldTable<Struct> Table;
+		typedef std::make_index_sequence<Table::Size> Indices;
+
+		static void read(std::string_view json, size_t& start, Struct& val)
+		{
+			bool present[Table::Size + 1] = {};
+			consumeToken(json, start, '{');
+			if (peekToken(json, start) != '}')
+			{
+				size_t hint = 0;
+				while (true)
+				{
+					if ('\"' != peekToken(json, start))
+						throwMalformedJSon(json, start);
+
+					auto key = parseString(json, start);
+					consumeToken(json, start, ':');
+					peekToken(json, start);
+
+					auto index = Table::find(key, hint);
+					if (index < Table::Size)
+					{
+						readJSonField(json, start, val, index, Indices());
+						present[index] = true;
+						hint = index + 1;
+					}
+					else
+						skipJSonValue(json, start);
+
+					char currentChar = peekToken(json, start);
+					start++;
+					if ('}' == currentChar)
+						break;
+					else if (',' != currentChar)
+						throwMalformedJSon(json, start - 1);
+				}
+			}
+			else
+				start++;
+
+			checkJSonFields(val, present, Indices());
+		}
+
+		template<typename Sink>
+		static void write(Sink& sink, const Struct& val)
+		{
+			sink.append('{');
+			writeJSonFields(sink, val, Indices());
+			sink.append('}');
+		}
+	};
+
+	//Fills a bound struct straight from the text of an object
+	template<typename Struct>
+	void deseraliseStructFromJSon(std::string_view jsonString, Struct& val)
+	{
+		size_t start = 0;
+		JSonCodec<Struct>::read(jsonString, start, val);
+	}
+
+	template<typename Struct>
+	Struct deseraliseStructFromJSon(std::string_view jsonString)
+	{
+		Struct val;
+		deseraliseStructFromJSon(jsonString, val);
+		return val;
+	}
+
+	template<typename Sink, typename Struct>
+	void serializeStructToJSon(const Struct& val, Sink&& sink)
+	{
+		JSonCodec<Struct>::write(sink, val);
+	}
+
+	template<typename Struct>
+	std::string serializeStructToJSon(const Struct& val)
+	{
+		std::string str;
+		serializeStructToJSon(val, StringSink(str));
+		return str;
+	}
+}
@@ -0,0 +1,518 @@
+#pragma once
+#include "CommonUtils/PropertyTree.hpp"
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string_view>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define UL_JSON_SCANNER_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define UL_TARGET_SSE42
+#define UL_TARGET_AVX2
+#else
+#define UL_TARGET_SSE42 __attribute__((target("sse4.2")))
+#define UL_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace ULCommonUtils
+{
+	enum class JSonScannerKind
+	{
+		Scalar,
+		Sse42,
+		Avx2
+	};
+
+	namespace
+	{
+		//Bit i of every mask describes byte i of a 64 byte block
+		struct JSonBlockMasks
+		{
+			uint64_t m_quote;
+			uint64_t m_backslash;
+			uint64_t m_singleQuote;
+			uint64_t m_structural;
+			uint64_t m_whiteSpace;
+		};
+
+		//Carries the state of one block into the next
+		struct JSonScanState
+		{
+			uint64_t m_escaped = 0;
+			uint64_t m_inString = 0;
+			uint64_t m_singleQuote = 0;
+			uint64_t m_charLiteral = 0;		//Bits of a char literal that spill into the next block
+			uint64_t m_charLiteralEnd = 0;
+			uint64_t m_boundary = 1;
+		};
+
+		inline unsigned countTrailingZeros(uint64_t val)
+		{
+#ifdef _MSC_VER
+			unsigned long index;
+			return _BitScanForward64(&index, val) ? index : 64;
+#else
+			return (0 == val) ? 64 : __builtin_ctzll(val);
+#endif
+		}
+
+		inline unsigned countBits(uint64_t val)
+		{
+#ifdef _MSC_VER
+			return static_cast<unsigned>(__popcnt64(val));
+#else
+			return __builtin_popcountll(val);
+#endif
+		}
+
+		inline uint64_t prefixXor(uint64_t val)
+		{
+			val ^= val << 1;
+			val ^= val << 2;
+			val ^= val << 4;
+			val ^= val << 8;
+			val ^= val << 16;
+			val ^= val << 32;
+			return val;
+		}
+
+		//Marks the characters escaped by an odd run of backslashes, runs may continue from the previous block
+		inline uint64_t findEscaped(uint64_t backslash, uint64_t& prevEscaped)
+		{
+			const uint64_t evenBits = 0x5555555555555555ULL;
+			backslash &= ~prevEscaped;
+			uint64_t followsEscape = (backslash << 1) | prevEscaped;
+			uint64_t oddSequenceStarts = backslash & ~evenBits & ~followsEscape;
+			uint64_t sequencesStartingOnEvenBits = oddSequenceStarts + backslash;
+			prevEscaped = (sequencesStartingOnEvenBits < oddSequenceStarts) ? 1 : 0;
+			uint64_t invertMask = sequencesStartingOnEvenBits << 1;
+			return (evenBits ^ invertMask) & followsEscape;
+		}
+
+		inline void classifyScalar(const char* block, JSonBlockMasks& masks)
+		{
+			masks = JSonBlockMasks();
+			for (unsigned i = 0; i < 64; i++)
+			{
+				uint64_t bit = uint64_t(1) << i;
+				switch (block[i])
+				{
+				case '\"': masks.m_quote |= bit; break;
+				case '\\': masks.m_backslash |= bit; break;
+				case '\'': masks.m_singleQuote |= bit; break;
+				case '{': case '}': case '[': case ']': case ':': case ',': masks.m_structural |= bit; break;
+				case ' ': case '\t': case '\n': case '\r': masks.m_whiteSpace |= bit; break;
+				default: break;
+				}
+			}
+		}
+
+#ifdef UL_JSON_SCANNER_X86
+		UL_TARGET_SSE42 inline uint64_t equalMaskSse42(__m128i chunk, char ch)
+		{
+			return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(ch))));
+		}
+
+		UL_TARGET_SSE42 inline void classifySse42(const char* block, JSonBlockMasks& masks)
+		{
+			masks = JSonBlockMasks();
+			for (unsigned i = 0; i < 4; i++)
+			{
+				__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * i));
+				//'[' and ']' differ from '{' and '}' only in bit 0x20
+				__m128i folded = _mm_or_si128(chunk, _mm_set1_epi8(0x20));
+				unsigned shift = 16 * i;
+				masks.m_quote |= equalMaskSse42(chunk, '\"') << shift;
+				masks.m_backslash |= equalMaskSse42(chunk, '\\') << shift;
+				masks.m_singleQuote |= equalMaskSse42(chunk, '\'') << shift;
+				masks.m_structural |= (equalMaskSse42(folded, '{') | equalMaskSse42(folded, '}') | equalMaskSse42(chunk, ':') | equalMaskSse42(chunk, ',')) << shift;
+				masks.m_whiteSpace |= (equalMaskSse42(chunk, ' ') | equalMaskSse42(chunk, '\t') | equalMaskSse42(chunk, '\n') | equalMaskSse42(chunk, '\r')) << shift;
+			}
+		}
+
+		UL_TARGET_AVX2 inline uint64_t equalMaskAvx2(__m256i chunk, char ch)
+		{
+			return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(ch))));
+		}
+
+		UL_TARGET_AVX2 inline void classifyAvx2(const char* block, JSonBlockMasks& masks)
+		{
+			masks = JSonBlockMasks();
+			for (unsigned i = 0; i < 2; i++)
+			{
+				__m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32 * i));
+				__m256i folded = _mm256_or_si256(chunk, _mm256_set1_epi8(0x20));
+				unsigned shift = 32 * i;
+				masks.m_quote |= equalMaskAvx2(chunk, '\"') << shift;
+				masks.m_backslash |= equalMaskAvx2(chunk, '\\') << shift;
+				masks.m_singleQuote |= equalMaskAvx2(chunk, '\'') << shift;
+				masks.m_structural |= (equalMaskAvx2(folded, '{') | equalMaskAvx2(folded, '}') | equalMaskAvx2(chunk, ':') | equalMaskAvx2(chunk, ',')) << shift;
+				masks.m_whiteSpace |= (equalMaskAvx2(chunk, ' ') | equalMaskAvx2(chunk, '\t') | equalMaskAvx2(chunk, '\n') | equalMaskAvx2(chunk, '\r')) << shift;
+			}
+		}
+#endif
+
+		//Turns the character masks of one block into index entries: structural characters and quotes outside strings
+		//and the first character of every other value (numbers and char literals).
+		//The character inside a char literal, e.g. ':' or '"', is data and never an entry.
+		inline uint32_t* indexBlock(const JSonBlockMasks& masks, bool nextIsSingleQuote, uint64_t validBits, JSonScanState& state, uint32_t base, uint32_t* out)
+		{
+			//A quote can only sit between two single quotes inside a char literal
+			uint64_t sq = masks.m_singleQuote;
+			uint64_t quoteLiteral = ((sq << 1) | (state.m_singleQuote >> 63)) & ((sq >> 1) | (uint64_t(nextIsSingleQuote) << 63));
+			state.m_singleQuote = sq;
+
+			uint64_t quotes = masks.m_quote & ~findEscaped(masks.m_backslash, state.m_escaped) & ~quoteLiteral;
+			uint64_t inString = prefixXor(quotes) ^ state.m_inString;
+			state.m_inString = uint64_t(0) - (inString >> 63);
+
+			//Every single quote outside a string that is not part of an earlier literal opens a three character literal
+			uint64_t charLiteral = state.m_charLiteral;
+			uint64_t charLiteralEnd = state.m_charLiteralEnd;
+			state.m_charLiteral = 0;
+			state.m_charLiteralEnd = 0;
+			for (uint64_t opens = sq & ~inString & ~charLiteral & ~charLiteralEnd; 0 != opens; opens &= opens - 1)
+			{
+				unsigned open = countTrailingZeros(opens);
+				if (open < 63)
+				{
+					charLiteral |= uint64_t(1) << (open + 1);
+					opens &= ~(uint64_t(1) << (open + 1));
+				}
+				else
+					state.m_charLiteral = 1;
+
+				if (open < 62)
+				{
+					charLiteralEnd |= uint64_t(1) << (open + 2);
+					opens &= ~(uint64_t(1) << (open + 2));
+				}
+				else
+					state.m_charLiteralEnd = uint64_t(1) << (open - 62);
+			}
+
+			uint64_t boundary = (masks.m_structural | masks.m_whiteSpace) & ~inString & ~charLiteral;
+			uint64_t structural = masks.m_structural & ~inString & ~charLiteral;
+			uint64_t scalar = ~(masks.m_structural | masks.m_whiteSpace | masks.m_quote) & ~inString & ~charLiteral & ~charLiteralEnd;
+			uint64_t scalarStart = scalar & ((boundary << 1) | state.m_boundary);
+			state.m_boundary = boundary >> 63;
+
+			//Entries are written eight at a time, the output has room for a whole block of slack
+			uint64_t entries = (structural | quotes | scalarStart) & validBits;
+			uint32_t* end = out + countBits(entries);
+			while (out < end)
+			{
+				for (unsigned i = 0; i < 8; i++)
+				{
+					out[i] = base + countTrailingZeros(entries);
+					entries &= entries - 1;
+				}
+
+				out += 8;
+			}
+
+			return end;
+		}
+
+		//Indexes json[begin, end) continuing from the state the previous range left, every range but the last one has to
+		//span a multiple of 64 characters. The output needs room for end - begin + 64 entries.
+		template<void (*Classify)(const char*, JSonBlockMasks&)>
+		uint32_t* scanJSonRange(std::string_view json, size_t begin, size_t end, JSonScanState& state, uint32_t* out)
+		{
+			JSonBlockMasks masks;
+			size_t base = begin;
+			for (; base + 64 <= end; base += 64)
+			{
+				Classify(json.data() + base, masks);
+				bool nextIsSingleQuote = (base + 64 < json.length()) && ('\'' == json[base + 64]);
+				out = indexBlock(masks, nextIsSingleQuote, ~uint64_t(0), state, static_cast<uint32_t>(base), out);
+			}
+
+			if (base < end)
+			{
+				char block[64];
+				std::memset(block, ' ', sizeof(block));
+				std::memcpy(block, json.data() + base, end - base);
+				Classify(block, masks);
+				out = indexBlock(masks, false, (uint64_t(1) << (end - base)) - 1, state, static_cast<uint32_t>(base), out);
+			}
+
+			return out;
+		}
+
+		template<void (*Classify)(const char*, JSonBlockMasks&)>
+		size_t scanJSon(std::string_view json, std::vector<uint32_t>& positions)
+		{
+			JSonScanState state;
+
+			//A document never has more entries than characters, the storage only ever grows
+			if (positions.size() < json.length() + 64)
+				positions.resize(json.length() + 64);
+
+			return scanJSonRange<Classify>(json, 0, json.length(), state, positions.data()) - positions.data();
+		}
+
+		inline JSonScannerKind detectJSonScanner()
+		{
+#ifdef UL_JSON_SCANNER_X86
+#ifdef _MSC_VER
+			int info[4];
+			__cpuid(info, 0);
+			int maxLeaf = info[0];
+			__cpuid(info, 1);
+			bool sse42 = (0 != (info[2] & (1 << 20)));
+			bool osAvx = (0 != (info[2] & (1 << 27))) && (0 != (info[2] & (1 << 28))) && (6 == (_xgetbv(0) & 6));
+			if (osAvx && (maxLeaf >= 7))
+			{
+				__cpuidex(info, 7, 0);
+				if (0 != (info[1] & (1 << 5)))
+					return JSonScannerKind::Avx2;
+			}
+
+			if (sse42)
+				return JSonScannerKind::Sse42;
+#else
+			__builtin_cpu_init();
+			if (__builtin_cpu_supports("avx2"))
+				return JSonScannerKind::Avx2;
+			else if (__builtin_cpu_supports("sse4.2"))
+				return JSonScannerKind::Sse42;
+#endif
+#endif
+			return JSonScannerKind::Scalar;
+		}
+	}
+
+	//Best scanner supported by the cpu this process runs on
+	inline JSonScannerKind activeJSonScanner()
+	{
+		static const JSonScannerKind kind = detectJSonScanner();
+		return kind;
+	}
+
+	namespace
+	{
+		inline uint32_t* scanJSonRange(JSonScannerKind kind, std::string_view json, size_t begin, size_t end, JSonScanState& state, uint32_t* out)
+		{
+			switch (kind)
+			{
+#ifdef UL_JSON_SCANNER_X86
+			case JSonScannerKind::Avx2:
+				return scanJSonRange<classifyAvx2>(json, begin, end, state, out);
+			case JSonScannerKind::Sse42:
+				return scanJSonRange<classifySse42>(json, begin, end, state, out);
+#endif
+			default:
+				return scanJSonRange<classifyScalar>(json, begin, end, state, out);
+			}
+		}
+	}
+
+	//Positions of every token of a JSon document: structural characters and both quotes of every string outside
+	//of strings, and the first character of every number or char literal.
+	//Reusing the same index across documents keeps its storage.
+	class JSonStructuralIndex
+	{
+		std::vector<uint32_t> m_positions;
+		size_t m_size = 0;
+
+	public:
+		void build(std::string_view json)
+		{
+			build(json, activeJSonScanner());
+		}
+
+		void build(std::string_view json, JSonScannerKind kind)
+		{
+			if (json.length() > std::numeric_limits<uint32_t>::max())
+				throw std::runtime_error("JSon document too large to index");
+
+			switch (kind)
+			{
+#ifdef UL_JSON_SCANNER_X86
+			case JSonScannerKind::Avx2:
+				m_size = scanJSon<classifyAvx2>(json, m_positions);
+				break;
+			case JSonScannerKind::Sse42:
+				m_size = scanJSon<classifySse42>(json, m_positions);
+				break;
+#endif
+			default:
+				m_size = scanJSon<classifyScalar>(json, m_positions);
+			}
+		}
+
+		size_t size() const
+		{
+			return m_size;
+		}
+
+		uint32_t operator [](size_t index) const
+		{
+			return m_positions[index];
+		}
+
+		const uint32_t* data() const
+		{
+			return m_positions.data();
+		}
+	};
+
+	namespace
+	{
+		//Builds a tree by jumping from token to token of a structural index instead of looking at every character
+		class IndexedJSonReader
+		{
+			typedef JSonPropertyTree::Node Node;
+			typedef JSonPropertyTree::Nodes Nodes;
+
+			std::string_view m_json;
+			const uint32_t* m_positions;
+			size_t m_size;
+			size_t m_token;
+
+			size_t position() const
+			{
+				return (m_token < m_size) ? m_positions[m_token] : m_json.length();
+			}
+
+			char peek() const
+			{
+				if (m_token >= m_size)
+					throwMalformedJSon(m_json, m_json.length());
+
+				return m_json[m_positions[m_token]];
+			}
+
+			void expect(char ch)
+			{
+				if (peek() != ch)
+					throwMalformedJSon(m_json, position());
+
+				m_token++;
+			}
+
+			//Both quotes of a string are consecutive tokens
+			std::string_view readString()
+			{
+				size_t open = position();
+				m_token++;
+				if (peek() != '\"')
+					throwMalformedJSon(m_json, position());
+
+				size_t close = position();
+				m_token++;
+				return m_json.substr(open + 1, close - open - 1);
+			}
+
+			//A number or char literal runs up to the next token
+			Node readScalar()
+			{
+				size_t begin = position();
+				m_token++;
+				size_t end = position();
+				while ((end > begin) && isJSonWhiteSpace(m_json[end - 1]))
+					end--;
+
+				auto token = m_json.substr(begin, end - begin);
+				size_t cursor = 0;
+				Node val = ('\'' == token[0]) ? Node(parseChar(token, cursor)) : parseNumber(token, cursor);
+				if (cursor != token.length())
+					throwMalformedJSon(m_json, begin + cursor);
+
+				return val;
+			}
+
+			void readValue(Node& val)
+			{
+				switch (peek())
+				{
+				case '{':
+					val = JSonPropertyTree();
+					readObject(boost::get<JSonPropertyTree>(val));
+					break;
+				case '[':
+					val = Nodes();
+					readArray(boost::get<Nodes>(val));
+					break;
+				case '\"':
+					val = std::string(readString());
+					break;
+				default:
+					val = readScalar();
+				}
+			}
+
+			void readArray(Nodes& nodes)
+			{
+				expect('[');
+				if (peek() == ']')
+				{
+					m_token++;
+					return;
+				}
+
+				while (true)
+				{
+					readValue(nodes.emplace_back(0));
+					char currentChar = peek();
+					m_token++;
+					if (']' == currentChar)
+						break;
+					else if (',' != currentChar)
+						throwMalformedJSon(m_json, m_positions[m_token - 1]);
+				}
+			}
+
+		public:
+			IndexedJSonReader(std::string_view json, const JSonStructuralIndex& index) :
+				m_json(json),
+				m_positions(index.data()),
+				m_size(index.size()),
+				m_token(0)
+			{
+			}
+
+			void readObject(JSonPropertyTree& pt)
+			{
+				expect('{');
+				if (peek() == '}')
+				{
+					m_token++;
+					return;
+				}
+
+				while (true)
+				{
+					if (peek() != '\"')
+						throwMalformedJSon(m_json, position());
+
+					auto key = readString();
+					expect(':');
+					//A default constructed member would allocate an empty subtree only to replace it
+					readValue(pt.try_emplace(JSonPropertyTree::NodeContainer::key_type(key), 0).first->second);
+
+					char currentChar = peek();
+					m_token++;
+					if ('}' == currentChar)
+						break;
+					else if (',' != currentChar)
+						throwMalformedJSon(m_json, m_positions[m_token - 1]);
+				}
+			}
+		};
+	}
+
+	//Parses a document whose structural index has already been built, suited to large documents
+	inline JSonPropertyTree deseraliseFromJSon(std::string_view jsonString, const JSonStructuralIndex& index)
+	{
+		JSonPropertyTree pt;
+		IndexedJSonReader(jsonString, index).readObject(pt);
+		return pt;
+	}
+}
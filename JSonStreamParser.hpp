@@ -0,0 +1,373 @@
+#pragma once
+#include "CommonUtils/PropertyTree.hpp"
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ULCommonUtils
+{
+	//Push parser for JSon text arriving in chunks of arbitrary size, e.g. fragments read from a socket.
+	//Every chunk is consumed completely, a string or number cut by a chunk boundary is carried over to the next chunk.
+	//Consecutive top level objects in the same stream are parsed one after the other.
+	//
+	//The Handler receives SAX style events:
+	//	void onStartObject();
+	//	void onEndObject();
+	//	void onStartArray();
+	//	void onEndArray();
+	//	void onKey(std::string_view key);
+	//	void onScalar(JSonPropertyTree::Node&& value);
+	//Views passed to onKey are only valid for the duration of the call.
+	template<typename Handler>
+	class JSonStreamParser
+	{
+		enum class State
+		{
+			ExpectDocument,
+			ExpectValue,
+			ExpectValueOrArrayEnd,
+			ExpectKey,
+			ExpectKeyOrObjectEnd,
+			ExpectColon,
+			ExpectCommaOrEnd,
+			InKey,
+			InString,
+			InCharValue,
+			InCharEnd,
+			InNumber
+		};
+
+		Handler& m_handler;
+		State m_state;
+		std::vector<char> m_containers;	//'{' or '[' for every open container
+		std::string m_token;			//Part of a string or number that started in an earlier chunk
+		bool m_spilled;
+		bool m_escaped;
+		char m_char;
+		size_t m_offset;				//Stream offset of the first character of the current chunk
+
+		[[noreturn]] void throwUnexpected(std::string_view chunk, size_t pos) const
+		{
+			throw std::runtime_error(std::string("Malformed JSon message, unexpected character \'") + chunk[pos] + "\' at stream offset " + std::to_string(m_offset + pos));
+		}
+
+		void onValueEnd()
+		{
+			m_state = m_containers.empty() ? State::ExpectDocument : State::ExpectCommaOrEnd;
+		}
+
+		void onContainerStart(char ch)
+		{
+			m_containers.push_back(ch);
+			if ('{' == ch)
+			{
+				m_state = State::ExpectKeyOrObjectEnd;
+				m_handler.onStartObject();
+			}
+			else
+			{
+				m_state = State::ExpectValueOrArrayEnd;
+				m_handler.onStartArray();
+			}
+		}
+
+		void onContainerEnd(std::string_view chunk, size_t pos)
+		{
+			char open = m_containers.back();
+			if ((('{' == open) && ('}' != chunk[pos])) || (('[' == open) && (']' != chunk[pos])))
+				throwUnexpected(chunk, pos);
+
+			m_containers.pop_back();
+			if ('{' == open)
+				m_handler.onEndObject();
+			else
+				m_handler.onEndArray();
+
+			onValueEnd();
+		}
+
+		//Returns the complete token, either straight out of the chunk or out of the carry over buffer
+		std::string_view completeToken(std::string_view chunk, size_t tokenStart, size_t tokenEnd)
+		{
+			if (!m_spilled)
+				return chunk.substr(tokenStart, tokenEnd - tokenStart);
+
+			m_token.append(chunk.data() + tokenStart, tokenEnd - tokenStart);
+			m_spilled = false;
+			return m_token;
+		}
+
+		void startToken(State state)
+		{
+			m_state = state;
+			m_token.clear();
+			m_spilled = false;
+			m_escaped = false;
+		}
+
+		static bool isNumberCharacter(char ch)
+		{
+			return (0 != std::isdigit(static_cast<unsigned char>(ch))) || ('.' == ch) || ('-' == ch) || ('+' == ch) || ('e' == ch) || ('E' == ch);
+		}
+
+		void startValue(std::string_view chunk, size_t pos, size_t& tokenStart)
+		{
+			char ch = chunk[pos];
+			if (('{' == ch) || ('[' == ch))
+				onContainerStart(ch);
+			else if ('\"' == ch)
+			{
+				startToken(State::InString);
+				tokenStart = pos + 1;
+			}
+			else if ('\'' == ch)
+				m_state = State::InCharValue;
+			else if (isNumberCharacter(ch))
+			{
+				startToken(State::InNumber);
+				tokenStart = pos;
+			}
+			else
+				throwUnexpected(chunk, pos);
+		}
+
+		void finishNumber(std::string_view chunk, size_t tokenStart, size_t tokenEnd)
+		{
+			auto number = completeToken(chunk, tokenStart, tokenEnd);
+			size_t pos = 0;
+			auto val = parseNumber(number, pos);
+			if (pos != number.length())
+				throw std::runtime_error(std::string("Malformed JSon message, invalid number \'") + std::string(number) + "\' before stream offset " + std::to_string(m_offset + tokenEnd));
+
+			m_handler.onScalar(std::move(val));
+			onValueEnd();
+		}
+
+	public:
+		JSonStreamParser(Handler& handler) :
+			m_handler(handler),
+			m_state(State::ExpectDocument),
+			m_spilled(false),
+			m_escaped(false),
+			m_char(0),
+			m_offset(0)
+		{
+		}
+
+		void feed(const char* data, size_t length)
+		{
+			feed(std::string_view(data, length));
+		}
+
+		void feed(std::string_view chunk)
+		{
+			size_t tokenStart = 0;
+			for (size_t pos = 0; pos < chunk.length(); pos++)
+			{
+				char ch = chunk[pos];
+				switch (m_state)
+				{
+				case State::InKey:
+				case State::InString:
+					if (m_escaped)
+						m_escaped = false;
+					else if ('\\' == ch)
+						m_escaped = true;
+					else if ('\"' == ch)
+					{
+						auto str = completeToken(chunk, tokenStart, pos);
+						if (State::InKey == m_state)
+						{
+							m_handler.onKey(str);
+							m_state = State::ExpectColon;
+						}
+						else
+						{
+							m_handler.onScalar(std::string(str));
+							onValueEnd();
+						}
+					}
+					break;
+				case State::InCharValue:
+					m_char = ch;
+					m_state = State::InCharEnd;
+					break;
+				case State::InCharEnd:
+					if ('\'' != ch)
+						throwUnexpected(chunk, pos);
+
+					m_handler.onScalar(m_char);
+					onValueEnd();
+					break;
+				case State::InNumber:
+					if (isNumberCharacter(ch))
+						break;
+
+					finishNumber(chunk, tokenStart, pos);
+					//The character that ended the number still has to be processed
+					pos--;
+					break;
+				default:
+					if (isJSonWhiteSpace(ch))
+						break;
+
+					switch (m_state)
+					{
+					case State::ExpectDocument:
+						if ('{' != ch)
+							throwUnexpected(chunk, pos);
+
+						onContainerStart(ch);
+						break;
+					case State::ExpectValue:
+						startValue(chunk, pos, tokenStart);
+						break;
+					case State::ExpectValueOrArrayEnd:
+						if (']' == ch)
+							onContainerEnd(chunk, pos);
+						else
+							startValue(chunk, pos, tokenStart);
+						break;
+					case State::ExpectKeyOrObjectEnd:
+						if ('}' == ch)
+						{
+							onContainerEnd(chunk, pos);
+							break;
+						}
+						[[fallthrough]];
+					case State::ExpectKey:
+						if ('\"' != ch)
+							throwUnexpected(chunk, pos);
+
+						startToken(State::InKey);
+						tokenStart = pos + 1;
+						break;
+					case State::ExpectColon:
+						if (':' != ch)
+							throwUnexpected(chunk, pos);
+
+						m_state = State::ExpectValue;
+						break;
+					case State::ExpectCommaOrEnd:
+						if (',' == ch)
+							m_state = ('{' == m_containers.back()) ? State::ExpectKey : State::ExpectValue;
+						else
+							onContainerEnd(chunk, pos);
+						break;
+					default:
+						break;
+					}
+				}
+			}
+
+			//Carry the unfinished token over to the next chunk
+			if ((State::InKey == m_state) || (State::InString == m_state) || (State::InNumber == m_state))
+			{
+				m_token.append(chunk.data() + tokenStart, chunk.length() - tokenStart);
+				m_spilled = true;
+			}
+
+			m_offset += chunk.length();
+		}
+
+		//True when no document is partially parsed
+		bool idle() const
+		{
+			return (State::ExpectDocument == m_state);
+		}
+
+		void reset()
+		{
+			m_state = State::ExpectDocument;
+			m_containers.clear();
+			m_token.clear();
+			m_spilled = false;
+			m_escaped = false;
+			m_offset = 0;
+		}
+	};
+
+	//Handler for JSonStreamParser which builds a JSonPropertyTree per top level object and hands every completed tree to the callback
+	class PropertyTreeBuilder
+	{
+	public:
+		typedef std::function<void(JSonPropertyTree&&)> Callback;
+
+	private:
+		typedef JSonPropertyTree::Node Node;
+		typedef JSonPropertyTree::Nodes Nodes;
+
+		struct Container
+		{
+			JSonPropertyTree* m_object;
+			Nodes* m_array;
+		};
+
+		Callback m_callback;
+		JSonPropertyTree m_root;
+		std::vector<Container> m_stack;
+		std::string m_key;
+
+		Node& nextSlot()
+		{
+			auto& parent = m_stack.back();
+			if (nullptr != parent.m_object)
+				return parent.m_object->try_emplace(m_key, 0).first->second;
+
+			return parent.m_array->emplace_back(0);
+		}
+
+	public:
+		PropertyTreeBuilder(Callback callback) :
+			m_callback(callback)
+		{
+		}
+
+		void onStartObject()
+		{
+			if (m_stack.empty())
+			{
+				m_stack.push_back({ &m_root, nullptr });
+				return;
+			}
+
+			auto& slot = nextSlot();
+			slot = JSonPropertyTree();
+			m_stack.push_back({ &boost::get<JSonPropertyTree>(slot), nullptr });
+		}
+
+		void onEndObject()
+		{
+			m_stack.pop_back();
+			if (m_stack.empty())
+			{
+				JSonPropertyTree completed;
+				completed.swap(m_root);
+				m_callback(std::move(completed));
+			}
+		}
+
+		void onStartArray()
+		{
+			auto& slot = nextSlot();
+			slot = Nodes();
+			m_stack.push_back({ nullptr, &boost::get<Nodes>(slot) });
+		}
+
+		void onEndArray()
+		{
+			m_stack.pop_back();
+		}
+
+		void onKey(std::string_view key)
+		{
+			m_key.assign(key.data(), key.length());
+		}
+
+		void onScalar(Node&& value)
+		{
+			nextSlot() = std::move(value);
+		}
+	};
+}
@@ -0,0 +1,298 @@
+#pragma once
+#include "CommonUtils/CommonDefs.hpp"
+#include "CommonUtils/RingBuffer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace ULCommonUtils
+{
+	namespace
+	{
+		//Tells the core that the thread is spinning, so that it backs off the contended line and frees resources for
+		//its sibling hyperthread
+		void cpuRelax()
+		{
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+			__builtin_ia32_pause();
+#endif
+		}
+	}
+
+	//Wait strategies of MPMCQueue. wait(ready) returns once ready() returned true, notify() is called after every
+	//change that may make a waiter ready. ready() only reads the queue, it may be called with a lock held.
+
+	//Lowest latency, keeps a core busy for every waiting thread. Only for as many threads as there are cores.
+	struct BusySpinWait
+	{
+		template<class Ready>
+		void wait(Ready&& ready)
+		{
+			while (!ready())
+				cpuRelax();
+		}
+
+		void notify() {}
+	};
+
+	//Spins briefly, then gives up the core between attempts
+	struct YieldingWait
+	{
+		template<class Ready>
+		void wait(Ready&& ready)
+		{
+			for (size_t spins = 0; !ready(); spins++)
+			{
+				if (spins < 100)
+					cpuRelax();
+				else
+					std::this_thread::yield();
+			}
+		}
+
+		void notify() {}
+	};
+
+	//Spins briefly, then sleeps on a condition variable. notify() takes the mutex only when a thread is asleep.
+	class BlockingWait
+	{
+		stdMutex m_mutex;
+		stdConditionVariable m_condition;
+		std::atomic<size_t> m_sleepers;
+
+	public:
+		BlockingWait() : m_sleepers(0) {}
+
+		template<class Ready>
+		void wait(Ready&& ready)
+		{
+			for (size_t spins = 0; spins < 100; spins++)
+			{
+				if (ready())
+					return;
+
+				cpuRelax();
+			}
+
+			stdUniqueLock lock(m_mutex);
+			m_sleepers.fetch_add(1, std::memory_order_relaxed);
+			//Orders the count before the checks of ready(), against the fence in notify()
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			m_condition.wait(lock, ready);
+			m_sleepers.fetch_sub(1, std::memory_order_relaxed);
+		}
+
+		void notify()
+		{
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (0 == m_sleepers.load(std::memory_order_relaxed))
+				return;
+
+			//A sleeper that saw the queue unchanged holds the mutex until it is waiting on the condition
+			{
+				stdUniqueLock lock(m_mutex);
+			}
+
+			m_condition.notify_all();
+		}
+	};
+
+	//Bounded queue for any number of producer and consumer threads. Each slot carries a sequence number telling
+	//whether it is free for the producer of a given position or holds the element for the consumer of it, so that
+	//threads only contend on the head or tail counter while claiming a position and never on a lock. The capacity is
+	//rounded up to a power of two, and to at least 2. Waiting for room or for an element in push() and pop() follows WaitStrategy.
+	template <class T, class WaitStrategy = YieldingWait>
+	class MPMCQueue
+	{
+		static constexpr size_t CacheLine = 64;
+
+		struct Cell
+		{
+			std::atomic<size_t> m_sequence;
+			std::aligned_storage_t<sizeof(T), alignof(T)> m_storage;
+
+			T* element()
+			{
+				return std::launder(reinterpret_cast<T*>(&m_storage));
+			}
+		};
+
+		const std::unique_ptr<Cell[]> m_cells;
+		const size_t m_mask;
+
+		alignas(CacheLine) std::atomic<size_t> m_tail;
+		alignas(CacheLine) std::atomic<size_t> m_head;
+
+		alignas(CacheLine) WaitStrategy m_notEmpty;
+		alignas(CacheLine) WaitStrategy m_notFull;
+
+		//Claims the cell at the tail for a producer, nullptr if the queue is full
+		Cell* claimTail(size_t& position)
+		{
+			position = m_tail.load(std::memory_order_relaxed);
+			for (;;)
+			{
+				Cell& cell = m_cells[position & m_mask];
+				auto lag = static_cast<intptr_t>(cell.m_sequence.load(std::memory_order_acquire) - position);
+				if (0 == lag)
+				{
+					if (m_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+						return &cell;
+				}
+				else if (lag < 0)
+					return nullptr;
+				else
+					position = m_tail.load(std::memory_order_relaxed);
+			}
+		}
+
+		//Claims the cell at the head for a consumer, nullptr if the queue is empty
+		Cell* claimHead(size_t& position)
+		{
+			position = m_head.load(std::memory_order_relaxed);
+			for (;;)
+			{
+				Cell& cell = m_cells[position & m_mask];
+				auto lag = static_cast<intptr_t>(cell.m_sequence.load(std::memory_order_acquire) - (position + 1));
+				if (0 == lag)
+				{
+					if (m_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+						return &cell;
+				}
+				else if (lag < 0)
+					return nullptr;
+				else
+					position = m_head.load(std::memory_order_relaxed);
+			}
+		}
+
+		//With a single cell, holding the element of a position and being free for the next one would be the same sequence
+		static size_t cellCount(size_t capacity)
+		{
+			return ringSlots(std::max<size_t>(capacity, 2));
+		}
+
+	public:
+		explicit MPMCQueue(size_t capacity) :
+			m_cells(new Cell[cellCount(capacity)]),
+			m_mask(cellCount(capacity) - 1),
+			m_tail(0),
+			m_head(0)
+		{
+			for (size_t i = 0; i <= m_mask; i++)
+				m_cells[i].m_sequence.store(i, std::memory_order_relaxed);
+		}
+
+		MPMCQueue(const MPMCQueue&) = delete;
+		MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+		//No thread may be using the queue any more
+		~MPMCQueue()
+		{
+			size_t position;
+			while (Cell* cell = claimHead(position))
+				cell->element()->~T();
+		}
+
+		//Constructs an element at the tail, false if the queue is full
+		template<class... Args>
+		bool try_emplace(Args&&... args)
+		{
+			size_t position;
+			Cell* cell = claimTail(position);
+			if (nullptr == cell)
+				return false;
+
+			new (&cell->m_storage) T(std::forward<Args>(args)...);
+			cell->m_sequence.store(position + 1, std::memory_order_release);
+			m_notEmpty.notify();
+			return true;
+		}
+
+		bool try_push(const T& item)
+		{
+			return try_emplace(item);
+		}
+
+		bool try_push(T&& item)
+		{
+			return try_emplace(std::move(item));
+		}
+
+		//Moves the element at the head to item, false if the queue is empty
+		bool try_pop(T& item)
+		{
+			size_t position;
+			Cell* cell = claimHead(position);
+			if (nullptr == cell)
+				return false;
+
+			item = std::move(*cell->element());
+			cell->element()->~T();
+			//Free for the producer one lap later
+			cell->m_sequence.store(position + m_mask + 1, std::memory_order_release);
+			m_notFull.notify();
+			return true;
+		}
+
+		//Whether the cell at the tail is free, or the tail has moved on since it was read
+		bool mayPush() const
+		{
+			size_t position = m_tail.load(std::memory_order_relaxed);
+			return static_cast<intptr_t>(m_cells[position & m_mask].m_sequence.load(std::memory_order_acquire) - position) >= 0;
+		}
+
+		bool mayPop() const
+		{
+			size_t position = m_head.load(std::memory_order_relaxed);
+			return static_cast<intptr_t>(m_cells[position & m_mask].m_sequence.load(std::memory_order_acquire) - (position + 1)) >= 0;
+		}
+
+		//Waits for room. The arguments are only moved from by the attempt that succeeds.
+		template<class... Args>
+		void emplace(Args&&... args)
+		{
+			while (!try_emplace(std::forward<Args>(args)...))
+				m_notFull.wait([this]() { return mayPush(); });
+		}
+
+		void push(const T& item)
+		{
+			emplace(item);
+		}
+
+		void push(T&& item)
+		{
+			emplace(std::move(item));
+		}
+
+		//Waits for an element
+		void pop(T& item)
+		{
+			while (!try_pop(item))
+				m_notEmpty.wait([this]() { return mayPop(); });
+		}
+
+		//Only a hint while other threads are running
+		size_t size() const
+		{
+			size_t head = m_head.load(std::memory_order_acquire);
+			return m_tail.load(std::memory_order_acquire) - head;
+		}
+
+		bool empty() const
+		{
+			return (0 == size());
+		}
+
+		size_t capacity() const
+		{
+			return m_mask + 1;
+		}
+	};
+}
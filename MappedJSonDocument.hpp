@@ -0,0 +1,411 @@
+#pragma once
+#include "CommonUtils/PropertyTree.hpp"
+#include "CommonUtils/JSonScanner.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ULCommonUtils
+{
+	//Read only mapping of a whole file
+	class MappedFile
+	{
+		const char* m_data;
+		size_t m_size;
+#ifdef _WIN32
+		HANDLE m_file;
+		HANDLE m_mapping;
+#endif
+
+		[[noreturn]] static void throwSystemError(const std::string& what, const std::string& path)
+		{
+			throw std::runtime_error(what + " failed for " + path);
+		}
+
+	public:
+		MappedFile(const std::string& path) :
+			m_data(nullptr),
+			m_size(0)
+		{
+#ifdef _WIN32
+			m_mapping = nullptr;
+			m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			if (INVALID_HANDLE_VALUE == m_file)
+				throwSystemError("open", path);
+
+			LARGE_INTEGER size;
+			if (!GetFileSizeEx(m_file, &size))
+			{
+				CloseHandle(m_file);
+				throwSystemError("stat", path);
+			}
+
+			m_size = static_cast<size_t>(size.QuadPart);
+			if (0 == m_size)
+				return;
+
+			m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (nullptr != m_mapping)
+				m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+
+			if (nullptr == m_data)
+			{
+				if (nullptr != m_mapping)
+					CloseHandle(m_mapping);
+
+				CloseHandle(m_file);
+				throwSystemError("mmap", path);
+			}
+#else
+			int fd = ::open(path.c_str(), O_RDONLY);
+			if (fd < 0)
+				throwSystemError("open", path);
+
+			struct stat status;
+			if (0 != ::fstat(fd, &status))
+			{
+				::close(fd);
+				throwSystemError("stat", path);
+			}
+
+			m_size = static_cast<size_t>(status.st_size);
+			if (0 != m_size)
+			{
+				void* data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+				if (MAP_FAILED == data)
+				{
+					::close(fd);
+					throwSystemError("mmap", path);
+				}
+
+				m_data = static_cast<const char*>(data);
+			}
+
+			//The mapping keeps the file open
+			::close(fd);
+#endif
+		}
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		~MappedFile()
+		{
+#ifdef _WIN32
+			if (nullptr != m_data)
+				UnmapViewOfFile(m_data);
+
+			if (nullptr != m_mapping)
+				CloseHandle(m_mapping);
+
+			CloseHandle(m_file);
+#else
+			if (nullptr != m_data)
+				::munmap(const_cast<char*>(m_data), m_size);
+#endif
+		}
+
+		std::string_view view() const
+		{
+			return std::string_view(m_data, m_size);
+		}
+
+		//Drops the resident pages of [begin, end) from the process, they are read again from the file when touched
+		void release(size_t begin, size_t end) const
+		{
+#ifndef _WIN32
+			static const size_t pageSize = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+			begin = (begin + pageSize - 1) / pageSize * pageSize;
+			end = (end < m_size) ? (end / pageSize * pageSize) : m_size;
+			if (begin < end)
+				::madvise(const_cast<char*>(m_data) + begin, end - begin, MADV_DONTNEED);
+#else
+			(void)begin;
+			(void)end;
+#endif
+		}
+	};
+
+	class LazyJSonDocument;
+
+	//Position of one value inside a LazyJSonDocument. Nothing is parsed until a member, an element or the value itself
+	//is asked for, and only the part of the document leading there is read.
+	class JSonValueView
+	{
+		const LazyJSonDocument* m_document;
+		size_t m_position;
+
+	public:
+		JSonValueView(const LazyJSonDocument& document, size_t position) :
+			m_document(&document),
+			m_position(position)
+		{
+		}
+
+		bool isObject() const;
+
+		bool isArray() const;
+
+		//Raw text of the value, escape sequences of strings are kept as they are
+		std::string_view text() const;
+
+		//Member of an object, std::nullopt if absent, throws for any other value
+		std::optional<JSonValueView> find(std::string_view key) const;
+
+		//Same semantics as BasicPropertyTree::find_path(): every key but the last one has to name a nested object
+		std::optional<JSonValueView> find_path(const JSonPropertyTree::Path& path) const;
+
+		//Element of an array, std::nullopt past its end, throws for any other value
+		std::optional<JSonValueView> at(size_t index) const;
+
+		//Builds the value and everything below it
+		JSonPropertyTree::Node materialize() const;
+
+		//Builds an object, throws for any other value
+		JSonPropertyTree materializeTree() const;
+	};
+
+	//Read only JSon document that builds trees on demand. Opening it scans the text once and records where every
+	//object or array spanning at least minimumSpan bytes ends, so lookups jump over large values and only scan small
+	//ones. Only the nesting is validated up front, malformed values are reported when they are reached.
+	//The text has to outlive the document and the views taken from it.
+	class LazyJSonDocument
+	{
+		friend class JSonValueView;
+
+		std::string_view m_json;
+		std::vector<std::pair<uint32_t, uint32_t>> m_spans;	//Open and close position of every large container, by open position
+
+		//Positions past a value starting at position
+		size_t skipValue(size_t position) const
+		{
+			if (('{' == m_json[position]) || ('[' == m_json[position]))
+			{
+				auto span = std::lower_bound(m_spans.begin(), m_spans.end(), std::make_pair(static_cast<uint32_t>(position), uint32_t(0)));
+				if ((span != m_spans.end()) && (span->first == position))
+					return span->second + 1;
+			}
+
+			skipJSonValue(m_json, position);
+			return position;
+		}
+
+		template<typename Release>
+		void index(size_t minimumSpan, Release release)
+		{
+			if (m_json.length() > std::numeric_limits<uint32_t>::max())
+				throw std::runtime_error("JSon document too large to index");
+
+			const size_t Window = 1 << 20;
+			std::vector<uint32_t> positions(Window + 64);
+			std::vector<std::pair<uint32_t, char>> open;
+			JSonScanState state;
+			auto kind = activeJSonScanner();
+			for (size_t begin = 0; begin < m_json.length(); begin += Window)
+			{
+				size_t end = std::min(m_json.length(), begin + Window);
+				auto last = scanJSonRange(kind, m_json, begin, end, state, positions.data());
+				for (auto entry = positions.data(); entry != last; entry++)
+				{
+					char ch = m_json[*entry];
+					if (('{' == ch) || ('[' == ch))
+						open.emplace_back(*entry, ch);
+					else if (('}' == ch) || (']' == ch))
+					{
+						if (open.empty() || (('{' == open.back().second) != ('}' == ch)))
+							throwMalformedJSon(m_json, *entry);
+
+						if (*entry - open.back().first >= minimumSpan)
+							m_spans.emplace_back(open.back().first, *entry);
+
+						open.pop_back();
+					}
+				}
+
+				release(begin, end);
+			}
+
+			if (!open.empty())
+				throwMalformedJSon(m_json, m_json.length());
+
+			std::sort(m_spans.begin(), m_spans.end());
+			m_spans.shrink_to_fit();
+
+			size_t start = 0;
+			if ('{' != peekToken(m_json, start))
+				throwMalformedJSon(m_json, start);
+		}
+
+	protected:
+		template<typename Release>
+		LazyJSonDocument(std::string_view json, size_t minimumSpan, Release release) :
+			m_json(json)
+		{
+			index(minimumSpan, release);
+		}
+
+	public:
+		static constexpr size_t DefaultMinimumSpan = 4096;
+
+		LazyJSonDocument(std::string_view json, size_t minimumSpan = DefaultMinimumSpan) :
+			m_json(json)
+		{
+			index(minimumSpan, [](size_t, size_t) {});
+		}
+
+		LazyJSonDocument(const LazyJSonDocument&) = delete;
+		LazyJSonDocument& operator=(const LazyJSonDocument&) = delete;
+
+		//The top level object
+		JSonValueView root() const
+		{
+			size_t start = 0;
+			skipWhiteSpaces(m_json, start);
+			return JSonValueView(*this, start);
+		}
+
+		std::optional<JSonValueView> find_path(const JSonPropertyTree::Path& path) const
+		{
+			return root().find_path(path);
+		}
+
+		//Containers recorded to be skipped in one step
+		size_t indexedSpans() const
+		{
+			return m_spans.size();
+		}
+	};
+
+	//LazyJSonDocument over a memory mapped file. The pages read while indexing are dropped again, so the resident size
+	//follows the parts of the file accessed afterwards rather than the file size.
+	class MappedJSonDocument : private MappedFile, public LazyJSonDocument
+	{
+	public:
+		MappedJSonDocument(const std::string& path, size_t minimumSpan = DefaultMinimumSpan) :
+			MappedFile(path),
+			LazyJSonDocument(view(), minimumSpan, [this](size_t begin, size_t end) { release(begin, end); })
+		{
+		}
+	};
+
+	inline bool JSonValueView::isObject() const
+	{
+		return ('{' == m_document->m_json[m_position]);
+	}
+
+	inline bool JSonValueView::isArray() const
+	{
+		return ('[' == m_document->m_json[m_position]);
+	}
+
+	inline std::string_view JSonValueView::text() const
+	{
+		return m_document->m_json.substr(m_position, m_document->skipValue(m_position) - m_position);
+	}
+
+	inline std::optional<JSonValueView> JSonValueView::find(std::string_view key) const
+	{
+		if (!isObject())
+			throw std::runtime_error("JSon value is not an object");
+
+		auto json = m_document->m_json;
+		size_t start = m_position;
+		consumeToken(json, start, '{');
+		if ('}' == peekToken(json, start))
+			return std::nullopt;
+
+		while (true)
+		{
+			if ('\"' != peekToken(json, start))
+				throwMalformedJSon(json, start);
+
+			auto member = parseString(json, start);
+			consumeToken(json, start, ':');
+			peekToken(json, start);
+			if (member == key)
+				return JSonValueView(*m_document, start);
+
+			start = m_document->skipValue(start);
+			char currentChar = peekToken(json, start);
+			start++;
+			if ('}' == currentChar)
+				return std::nullopt;
+			else if (',' != currentChar)
+				throwMalformedJSon(json, start - 1);
+		}
+	}
+
+	inline std::optional<JSonValueView> JSonValueView::find_path(const JSonPropertyTree::Path& path) const
+	{
+		if (path.empty())
+			return std::nullopt;
+
+		std::optional<JSonValueView> curr = *this;
+		for (auto& key : path)
+		{
+			if (!curr->isObject() || !(curr = curr->find(key)))
+				return std::nullopt;
+		}
+
+		return curr;
+	}
+
+	inline std::optional<JSonValueView> JSonValueView::at(size_t index) const
+	{
+		if (!isArray())
+			throw std::runtime_error("JSon value is not an array");
+
+		auto json = m_document->m_json;
+		size_t start = m_position;
+		consumeToken(json, start, '[');
+		if (']' == peekToken(json, start))
+			return std::nullopt;
+
+		for (size_t element = 0;; element++)
+		{
+			peekToken(json, start);
+			if (element == index)
+				return JSonValueView(*m_document, start);
+
+			start = m_document->skipValue(start);
+			char currentChar = peekToken(json, start);
+			start++;
+			if (']' == currentChar)
+				return std::nullopt;
+			else if (',' != currentChar)
+				throwMalformedJSon(json, start - 1);
+		}
+	}
+
+	inline JSonPropertyTree::Node JSonValueView::materialize() const
+	{
+		JSonPropertyTree::Node val(0);
+		size_t start = m_position;
+		parseValue<JSonPropertyTree>(m_document->m_json, start, val);
+		return val;
+	}
+
+	inline JSonPropertyTree JSonValueView::materializeTree() const
+	{
+		JSonPropertyTree pt;
+		size_t start = m_position;
+		parseObject(m_document->m_json, start, pt);
+		return pt;
+	}
+}
@@ -0,0 +1,262 @@
+#pragma once
+#include "CommonUtils/JSonScanner.hpp"
+#include "CommonUtils/PropertyTree.hpp"
+#include "CommonUtils/ThreadPool.hpp"
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <vector>
+
+namespace ULCommonUtils
+{
+	namespace
+	{
+		//Enough batches to keep every thread busy while a slow batch finishes, without paying for tiny tasks
+		inline size_t parallelBatchBytes(size_t length, const ThreadPool& pool)
+		{
+			return std::clamp<size_t>(length / (8 * pool.size()), 64 << 10, 4 << 20);
+		}
+
+		//Tasks read the caller's input, none may outlive the call even when another one failed
+		template<typename Result>
+		std::vector<Result> collectBatches(std::vector<std::future<Result>>& batches)
+		{
+			std::vector<Result> results;
+			try
+			{
+				for (auto& batch : batches)
+					results.push_back(batch.get());
+			}
+			catch (...)
+			{
+				for (auto& batch : batches)
+				{
+					if (batch.valid())
+						batch.wait();
+				}
+
+				throw;
+			}
+
+			return results;
+		}
+
+		//Records of json[begin, end), one object per line with blank lines allowed
+		template<typename Tree>
+		std::vector<Tree> parseNDJSonRange(std::string_view json, size_t begin, size_t end)
+		{
+			std::vector<Tree> records;
+			size_t start = begin;
+			while (true)
+			{
+				skipWhiteSpaces(json, start);
+				if (start >= end)
+					break;
+
+				size_t recordStart = start;
+				records.emplace_back();
+				parseObject(json, start, records.back());
+				if (auto newLine = static_cast<const char*>(std::memchr(json.data() + recordStart, '\n', start - recordStart)))
+					throwMalformedJSon(json, newLine - json.data());
+
+				while ((start < json.length()) && ('\n' != json[start]))
+				{
+					if (!isJSonWhiteSpace(json[start]))
+						throwMalformedJSon(json, start);
+
+					start++;
+				}
+			}
+
+			return records;
+		}
+
+		template<typename Tree>
+		struct JSonArrayBatch
+		{
+			std::vector<typename Tree::Node> m_elements;
+			size_t m_end;			//Position past the separator following the last element
+			char m_separator;
+		};
+
+		template<typename Tree>
+		JSonArrayBatch<Tree> parseJSonArrayBatch(std::string_view json, size_t start, size_t count)
+		{
+			JSonArrayBatch<Tree> batch;
+			batch.m_elements.reserve(count);
+			for (size_t i = 0; i < count; i++)
+			{
+				parseValue<Tree>(json, start, batch.m_elements.emplace_back(0));
+				batch.m_separator = peekToken(json, start);
+				if (((i + 1 < count) && (',' != batch.m_separator)) || ((',' != batch.m_separator) && (']' != batch.m_separator)))
+					throwMalformedJSon(json, start);
+
+				start++;
+			}
+
+			batch.m_end = start;
+			return batch;
+		}
+	}
+
+	//Parses newline delimited JSon, one object per line, on the threads of pool. The input is cut at line ends into
+	//batches parsed independently; the records are returned in input order.
+	//Tree may be any BasicPropertyTree<Policy, KeyType, String, char, int, long long, size_t, double>
+	template<typename Tree = JSonPropertyTree>
+	std::vector<Tree> deseraliseFromNDJSon(std::string_view json, ThreadPool& pool)
+	{
+		const size_t BatchBytes = parallelBatchBytes(json.length(), pool);
+		std::vector<std::future<std::vector<Tree>>> batches;
+		for (size_t begin = 0; begin < json.length();)
+		{
+			size_t end = json.length();
+			if (begin + BatchBytes < json.length())
+			{
+				auto newLine = static_cast<const char*>(std::memchr(json.data() + begin + BatchBytes, '\n', json.length() - begin - BatchBytes));
+				end = (nullptr != newLine) ? (newLine - json.data() + 1) : json.length();
+			}
+
+			batches.push_back(pool.submit([json, begin, end]() { return parseNDJSonRange<Tree>(json, begin, end); }));
+			begin = end;
+		}
+
+		auto results = collectBatches(batches);
+		size_t total = 0;
+		for (auto& result : results)
+			total += result.size();
+
+		std::vector<Tree> records;
+		records.reserve(total);
+		for (auto& result : results)
+			std::move(result.begin(), result.end(), std::back_inserter(records));
+
+		return records;
+	}
+
+	//Parses a document made of one large array on the threads of pool. The calling thread finds the boundaries of the
+	//top level elements with the structural scanner and hands batches of elements to the pool as it goes, so scanning
+	//overlaps with parsing. Malformed input is reported as by a sequential parse, though not necessarily the first error.
+	template<typename Tree = JSonPropertyTree>
+	typename Tree::Nodes deseraliseArrayFromJSon(std::string_view json, ThreadPool& pool)
+	{
+		typedef JSonArrayBatch<Tree> Batch;
+		const size_t BatchBytes = parallelBatchBytes(json.length(), pool);
+		const size_t Window = 1 << 20;
+
+		std::vector<std::future<Batch>> batches;
+		std::vector<size_t> batchStarts;
+		try
+		{
+			std::vector<uint32_t> positions(Window + 64);
+			JSonScanState state;
+			auto kind = activeJSonScanner();
+			size_t depth = 0, batchStart = 0, batchCount = 0;
+			bool opened = false, expectElement = false;
+			for (size_t windowBegin = 0; windowBegin < json.length(); windowBegin += Window)
+			{
+				//Scanning each window as a document of its own keeps positions within 32 bits for inputs of any size
+				auto window = json.substr(windowBegin);
+				auto last = scanJSonRange(kind, window, 0, std::min(Window, window.length()), state, positions.data());
+				for (auto entry = positions.data(); entry != last; entry++)
+				{
+					size_t position = windowBegin + *entry;
+					char ch = json[position];
+					if (0 == depth)
+					{
+						if (opened || ('[' != ch))
+							throwMalformedJSon(json, position);
+
+						opened = expectElement = true;
+						depth++;
+						continue;
+					}
+
+					if (expectElement && (1 == depth) && (']' != ch))
+					{
+						if ((0 != batchCount) && (position - batchStart >= BatchBytes))
+						{
+							batches.push_back(pool.submit([json, batchStart, batchCount]() { return parseJSonArrayBatch<Tree>(json, batchStart, batchCount); }));
+							batchStarts.push_back(batchStart);
+							batchCount = 0;
+						}
+
+						if (0 == batchCount)
+							batchStart = position;
+
+						batchCount++;
+					}
+
+					expectElement = false;
+					if (('{' == ch) || ('[' == ch))
+						depth++;
+					else if (('}' == ch) || (']' == ch))
+					{
+						if ((1 == depth) && (']' != ch))
+							throwMalformedJSon(json, position);
+
+						depth--;
+					}
+					else if ((',' == ch) && (1 == depth))
+						expectElement = true;
+				}
+			}
+
+			if (!opened || (0 != depth))
+				throwMalformedJSon(json, json.length());
+
+			if (0 != batchCount)
+			{
+				batches.push_back(pool.submit([json, batchStart, batchCount]() { return parseJSonArrayBatch<Tree>(json, batchStart, batchCount); }));
+				batchStarts.push_back(batchStart);
+			}
+		}
+		catch (...)
+		{
+			for (auto& batch : batches)
+				batch.wait();
+
+			throw;
+		}
+
+		auto results = collectBatches(batches);
+
+		//Batches have to join up exactly, as they would have in a sequential parse
+		size_t total = 0;
+		for (size_t i = 0; i < results.size(); i++)
+		{
+			size_t end = results[i].m_end;
+			skipWhiteSpaces(json, end);
+			if (i + 1 < results.size())
+			{
+				if ((',' != results[i].m_separator) || (end != batchStarts[i + 1]))
+					throwMalformedJSon(json, results[i].m_end - 1);
+			}
+			else if ((']' != results[i].m_separator) || (end != json.length()))
+				throwMalformedJSon(json, (']' != results[i].m_separator) ? results[i].m_end - 1 : end);
+
+			total += results[i].m_elements.size();
+		}
+
+		if (0 == total)
+			return typename Tree::Nodes();
+
+		//Every policy stores array elements contiguously, the batches are moved into place in parallel as well
+		typename Tree::Nodes nodes(total, typename Tree::Node(0));
+		auto elements = &nodes[0];
+		std::vector<std::future<size_t>> moves;
+		for (auto& result : results)
+		{
+			auto first = elements;
+			elements += result.m_elements.size();
+			moves.push_back(pool.submit([&result, first]()
+			{
+				std::move(result.m_elements.begin(), result.m_elements.end(), first);
+				std::vector<typename Tree::Node>().swap(result.m_elements);
+				return size_t(0);
+			}));
+		}
+
+		collectBatches(moves);
+		return nodes;
+	}
+}
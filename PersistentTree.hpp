@@ -0,0 +1,336 @@
+#pragma once
+#include "CommonUtils/PropertyTree.hpp"
+#include <atomic>
+#include <initializer_list>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace ULCommonUtils
+{
+	//Container shared between its copies until one of them is written to. Copying costs one reference count increment,
+	//the first non const access of a shared copy clones the container, whose elements are in turn shared.
+	//Reference counts are atomic: copies of one container may be read, copied and destroyed from several threads, each
+	//copy written to by one thread at a time. Iterators and references obtained through non const member functions
+	//point into this copy's own container; get them again after copying it, or the writes through them show in both.
+	template<typename Container>
+	class CopyOnWriteContainer
+	{
+		std::shared_ptr<Container> m_container;	//Null while empty and never written to
+
+	protected:
+		const Container& read() const
+		{
+			static const Container empty;
+			return m_container ? *m_container : empty;
+		}
+
+		Container& write()
+		{
+			if (!m_container)
+				m_container = std::make_shared<Container>();
+			else if (1 != m_container.use_count())
+				m_container = std::make_shared<Container>(*m_container);
+			else
+				std::atomic_thread_fence(std::memory_order_acquire);	//Pairs with the release of the last other copy
+
+			return *m_container;
+		}
+
+		bool isShared() const
+		{
+			return m_container && (1 != m_container.use_count());
+		}
+
+		CopyOnWriteContainer() {}
+
+		explicit CopyOnWriteContainer(std::shared_ptr<Container> container) : m_container(std::move(container)) {}
+
+	public:
+		typedef typename Container::value_type value_type;
+		typedef typename Container::size_type size_type;
+		typedef typename Container::iterator iterator;
+		typedef typename Container::const_iterator const_iterator;
+
+		iterator begin()
+		{
+			return write().begin();
+		}
+
+		iterator end()
+		{
+			return write().end();
+		}
+
+		const_iterator begin() const
+		{
+			return read().begin();
+		}
+
+		const_iterator end() const
+		{
+			return read().end();
+		}
+
+		size_t size() const
+		{
+			return read().size();
+		}
+
+		bool empty() const
+		{
+			return read().empty();
+		}
+
+		void clear()
+		{
+			m_container.reset();
+		}
+
+		void swap(CopyOnWriteContainer& other)
+		{
+			m_container.swap(other.m_container);
+		}
+
+		//True while both copies share one container
+		bool shares(const CopyOnWriteContainer& other) const
+		{
+			return m_container && (m_container == other.m_container);
+		}
+
+		bool operator==(const CopyOnWriteContainer& other) const
+		{
+			return shares(other) || (read() == other.read());
+		}
+
+		bool operator!=(const CopyOnWriteContainer& other) const
+		{
+			return !(*this == other);
+		}
+	};
+
+	template<typename Map>
+	class CopyOnWriteMap : public CopyOnWriteContainer<Map>
+	{
+		typedef CopyOnWriteContainer<Map> Base;
+
+	public:
+		typedef typename Map::key_type key_type;
+		typedef typename Map::mapped_type mapped_type;
+		typedef typename Map::hasher hasher;
+		typedef typename Base::value_type value_type;
+		typedef typename Base::iterator iterator;
+		typedef typename Base::const_iterator const_iterator;
+
+		iterator find(const key_type& key)
+		{
+			return this->write().find(key);
+		}
+
+		const_iterator find(const key_type& key) const
+		{
+			return this->read().find(key);
+		}
+
+		template<typename M = Map, typename = std::enable_if_t<HasHashedFind<M, key_type>::value>>
+		iterator find(const key_type& key, size_t hash)
+		{
+			return this->write().find(key, hash);
+		}
+
+		template<typename M = Map, typename = std::enable_if_t<HasHashedFind<M, key_type>::value>>
+		const_iterator find(const key_type& key, size_t hash) const
+		{
+			return this->read().find(key, hash);
+		}
+
+		size_t count(const key_type& key) const
+		{
+			return this->read().count(key);
+		}
+
+		mapped_type& operator[](const key_type& key)
+		{
+			return this->write()[key];
+		}
+
+		mapped_type& operator[](key_type&& key)
+		{
+			return this->write()[std::move(key)];
+		}
+
+		std::pair<iterator, bool> insert(const value_type& val)
+		{
+			return this->write().insert(val);
+		}
+
+		std::pair<iterator, bool> insert(value_type&& val)
+		{
+			return this->write().insert(std::move(val));
+		}
+
+		template<typename... Args>
+		std::pair<iterator, bool> emplace(Args&&... args)
+		{
+			return this->write().emplace(std::forward<Args>(args)...);
+		}
+
+		template<typename... Args>
+		std::pair<iterator, bool> try_emplace(const key_type& key, Args&&... args)
+		{
+			return this->write().try_emplace(key, std::forward<Args>(args)...);
+		}
+
+		template<typename... Args>
+		std::pair<iterator, bool> try_emplace(key_type&& key, Args&&... args)
+		{
+			return this->write().try_emplace(std::move(key), std::forward<Args>(args)...);
+		}
+
+		template<typename M>
+		std::pair<iterator, bool> insert_or_assign(const key_type& key, M&& val)
+		{
+			return this->write().insert_or_assign(key, std::forward<M>(val));
+		}
+
+		//position may point into a container shared with other copies, which is then looked up by key in our own clone
+		iterator erase(const_iterator position)
+		{
+			if (!this->isShared())
+				return this->write().erase(position);
+
+			key_type key = position->first;
+			auto& map = this->write();
+			return map.erase(map.find(key));
+		}
+
+		iterator erase(const_iterator first, const_iterator last)
+		{
+			if (!this->isShared())
+				return this->write().erase(first, last);
+
+			std::vector<key_type> keys;
+			for (auto it = first; it != last; it++)
+				keys.push_back(it->first);
+
+			std::optional<key_type> next;
+			if (last != this->read().end())
+				next = last->first;
+
+			auto& map = this->write();
+			for (auto& key : keys)
+				map.erase(key);
+
+			return next ? map.find(*next) : map.end();
+		}
+
+		//Removing an absent key leaves a shared container shared
+		size_t erase(const key_type& key)
+		{
+			if (this->read().find(key) == this->read().end())
+				return 0;
+
+			return this->write().erase(key);
+		}
+	};
+
+	template<typename Vector>
+	class CopyOnWriteVector : public CopyOnWriteContainer<Vector>
+	{
+		typedef CopyOnWriteContainer<Vector> Base;
+
+	public:
+		typedef typename Base::value_type value_type;
+		typedef typename Base::iterator iterator;
+		typedef typename Base::const_iterator const_iterator;
+		typedef typename Vector::reverse_iterator reverse_iterator;
+		typedef typename Vector::const_reverse_iterator const_reverse_iterator;
+
+		CopyOnWriteVector() {}
+
+		CopyOnWriteVector(std::initializer_list<value_type> init) : Base(std::make_shared<Vector>(init)) {}
+
+		CopyOnWriteVector(size_t n, const value_type& initializer) : Base(std::make_shared<Vector>(n, initializer)) {}
+
+		reverse_iterator rbegin()
+		{
+			return this->write().rbegin();
+		}
+
+		reverse_iterator rend()
+		{
+			return this->write().rend();
+		}
+
+		const_reverse_iterator rbegin() const
+		{
+			return this->read().rbegin();
+		}
+
+		const_reverse_iterator rend() const
+		{
+			return this->read().rend();
+		}
+
+		value_type& operator[](size_t index)
+		{
+			return this->write()[index];
+		}
+
+		const value_type& operator[](size_t index) const
+		{
+			return this->read()[index];
+		}
+
+		void push_back(const value_type& val)
+		{
+			this->write().push_back(val);
+		}
+
+		void push_back(value_type&& val)
+		{
+			this->write().push_back(std::move(val));
+		}
+
+		template<typename... Args>
+		value_type& emplace_back(Args&&... args)
+		{
+			return this->write().emplace_back(std::forward<Args>(args)...);
+		}
+
+		void pop_back()
+		{
+			this->write().pop_back();
+		}
+
+		//position may point into a container shared with other copies, which is then found by index in our own clone
+		iterator erase(const_iterator position)
+		{
+			auto index = position - this->read().begin();
+			auto& vector = this->write();
+			return vector.erase(vector.begin() + index);
+		}
+	};
+
+	//Persistent trees: copies cost O(1) and share every tree and array with the original, a change copies only the
+	//containers along the path to the changed node, each one shallowly. Versions sharing subtrees share their cached
+	//digests too, and diff() skips the subtrees they share, so both cost about the size of the change.
+	//A writer thread changes its own copy and hands out copies of it as snapshots; readers keep them as long as they
+	//like without blocking the writer or each other.
+	struct PersistentTreePolicy
+	{
+		static constexpr bool CacheDigests = true;
+
+		template<typename Key, typename Value>
+		using Map = CopyOnWriteMap<std::unordered_map<Key, Value>>;
+
+		template<typename Value>
+		using Vector = CopyOnWriteVector<std::vector<Value>>;
+
+		struct NodeBase {};
+	};
+
+	typedef BasicPropertyTree<PersistentTreePolicy, std::string, std::string, char, int, long long, size_t, double> PersistentPropertyTree;
+}
@@ -4,27 +4,478 @@
 #include <boost/variant/variant.hpp>
 #include <boost/variant/recursive_variant.hpp>
 #include <boost/variant/recursive_wrapper.hpp>
-#include <boost/lexical_cast.hpp>
 #include <string>
+#include <string_view>
+#include <charconv>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <cstring>
+#include <ostream>
+#include <type_traits>
 #include <regex>
 #include <unordered_map>
 #include <exception>
+#include <atomic>
+#include <cstdint>
 namespace ULCommonUtils
 {
-	template<typename KeyType, typename T, typename... Args>
-	struct PropertyTree;
+	//A policy decides how trees and arrays store their elements:
+	//	template<typename Key, typename Value> using Map		container of the key/value pairs of a tree
+	//	template<typename Value> using Vector				container of the elements of an array
+	//	NodeBase											base class of trees and arrays, may provide operator new/delete
+	//														for the heap allocations of subtrees and arrays
+	//	NodeVariant											optional, BoostNodeVariant or StdNodeVariant, boost when absent
+	struct DefaultTreePolicy
+	{
+		template<typename Key, typename Value>
+		using Map = std::unordered_map<Key, Value>;
+
+		template<typename Value>
+		using Vector = std::vector<Value>;
+
+		struct NodeBase {};
+	};
+
+	template<typename Policy, typename KeyType, typename T, typename... Args>
+	struct BasicPropertyTree;
+
+	template<typename Policy, typename KeyType, typename T, typename... Args>
+	struct BasicNodes;
+
+	//Heap slot of a subtree or array inside a node. Unlike boost's own wrapper, moving one hands over the pointer and
+	//cannot throw, so containers of nodes grow by moving instead of copying whole subtrees. A moved from slot reads
+	//as empty and allocates again only once written to.
+	template<typename Value>
+	class NodeHolder
+	{
+		mutable Value* m_value;
+
+	public:
+		typedef Value type;
+
+		NodeHolder() : m_value(new Value()) {}
+		NodeHolder(const Value& val) : m_value(new Value(val)) {}
+		NodeHolder(Value&& val) : m_value(new Value(std::move(val))) {}
+		NodeHolder(const NodeHolder& other) : m_value(new Value(other.get())) {}
+
+		NodeHolder(NodeHolder&& other) noexcept : m_value(other.m_value)
+		{
+			other.m_value = nullptr;
+		}
+
+		~NodeHolder()
+		{
+			delete m_value;
+		}
+
+		NodeHolder& operator=(const NodeHolder& other)
+		{
+			get() = other.get();
+			return *this;
+		}
+
+		NodeHolder& operator=(NodeHolder&& other) noexcept
+		{
+			swap(other);
+			return *this;
+		}
+
+		NodeHolder& operator=(const Value& val)
+		{
+			get() = val;
+			return *this;
+		}
+
+		NodeHolder& operator=(Value&& val)
+		{
+			get() = std::move(val);
+			return *this;
+		}
+
+		void swap(NodeHolder& other) noexcept
+		{
+			std::swap(m_value, other.m_value);
+		}
+
+		bool operator==(const NodeHolder& other) const
+		{
+			return get() == other.get();
+		}
+
+		bool operator!=(const NodeHolder& other) const
+		{
+			return !(*this == other);
+		}
+
+		Value& get()
+		{
+			return *get_pointer();
+		}
+
+		const Value& get() const
+		{
+			return *get_pointer();
+		}
+
+		Value* get_pointer()
+		{
+			if (nullptr == m_value)
+				m_value = new Value();
+
+			return m_value;
+		}
+
+		const Value* get_pointer() const
+		{
+			if (nullptr != m_value)
+				return m_value;
+
+			static const Value empty;
+			return &empty;
+		}
+	};
+}
+
+namespace boost
+{
+	template<typename Policy, typename KeyType, typename T, typename... Args>
+	class recursive_wrapper<ULCommonUtils::BasicPropertyTree<Policy, KeyType, T, Args...>> : public ULCommonUtils::NodeHolder<ULCommonUtils::BasicPropertyTree<Policy, KeyType, T, Args...>>
+	{
+		typedef ULCommonUtils::NodeHolder<ULCommonUtils::BasicPropertyTree<Policy, KeyType, T, Args...>> Holder;
+
+	public:
+		using Holder::Holder;
+		using Holder::operator=;
+	};
+
+	template<typename Policy, typename KeyType, typename T, typename... Args>
+	class recursive_wrapper<ULCommonUtils::BasicNodes<Policy, KeyType, T, Args...>> : public ULCommonUtils::NodeHolder<ULCommonUtils::BasicNodes<Policy, KeyType, T, Args...>>
+	{
+		typedef ULCommonUtils::NodeHolder<ULCommonUtils::BasicNodes<Policy, KeyType, T, Args...>> Holder;
+
+	public:
+		using Holder::Holder;
+		using Holder::operator=;
+	};
+
+	//boost::variant only moves without a backup copy when it is told its alternatives cannot throw while moving
+	template<typename Policy, typename KeyType, typename T, typename... Args>
+	struct is_nothrow_move_constructible<recursive_wrapper<ULCommonUtils::BasicPropertyTree<Policy, KeyType, T, Args...>>> : true_type {};
+
+	template<typename Policy, typename KeyType, typename T, typename... Args>
+	struct is_nothrow_move_constructible<recursive_wrapper<ULCommonUtils::BasicNodes<Policy, KeyType, T, Args...>>> : true_type {};
+}
+
+namespace ULCommonUtils
+{
+	//Representations of tree members and array elements, a policy picks one with `typedef StdNodeVariant NodeVariant;`.
+	//Both keep scalars inline and subtrees and arrays on the heap. The free functions getIf(), getValue(), visitNode()
+	//and nodeIndex() below work with either of them.
+	struct BoostNodeVariant
+	{
+		template<typename Tree, typename Nodes, typename... Scalars>
+		using Node = boost::variant<boost::recursive_wrapper<Tree>, boost::recursive_wrapper<Nodes>, Scalars...>;
+	};
+
+	//Failed type tests return nullptr from getIf() rather than going through exceptions, and visitation compiles to a
+	//jump table
+	struct StdNodeVariant
+	{
+		template<typename Tree, typename Nodes, typename... Scalars>
+		using Node = std::variant<NodeHolder<Tree>, NodeHolder<Nodes>, Scalars...>;
+	};
+
+	//Default containers with std::variant nodes
+	struct StdVariantTreePolicy
+	{
+		typedef StdNodeVariant NodeVariant;
+
+		template<typename Key, typename Value>
+		using Map = std::unordered_map<Key, Value>;
+
+		template<typename Value>
+		using Vector = std::vector<Value>;
+
+		struct NodeBase {};
+	};
+
+	template<typename Policy, typename = void>
+	struct NodeVariantOf
+	{
+		typedef BoostNodeVariant type;
+	};
+
+	template<typename Policy>
+	struct NodeVariantOf<Policy, std::void_t<typename Policy::NodeVariant>>
+	{
+		typedef typename Policy::NodeVariant type;
+	};
+
+	template<typename Policy, typename KeyType, typename T, typename... Args>
+	using BasicArrayElement = typename NodeVariantOf<Policy>::type::template Node<BasicPropertyTree<Policy, KeyType, T, Args...>, BasicNodes<Policy, KeyType, T, Args...>, T, Args...>;
+
+	template<typename Node>
+	struct IsStdNode : std::false_type {};
+
+	template<typename... Types>
+	struct IsStdNode<std::variant<Types...>> : std::true_type {};
+
+	namespace
+	{
+		template<typename Node, typename Value>
+		struct HoldsAlternative : std::false_type {};
+
+		template<typename... Types, typename Value>
+		struct HoldsAlternative<std::variant<Types...>, Value> : std::disjunction<std::is_same<Types, Value>...> {};
+
+		template<typename Value>
+		Value& unwrapNode(NodeHolder<Value>& holder)
+		{
+			return holder.get();
+		}
+
+		template<typename Value>
+		const Value& unwrapNode(const NodeHolder<Value>& holder)
+		{
+			return holder.get();
+		}
+
+		template<typename Value>
+		Value& unwrapNode(Value& val)
+		{
+			return val;
+		}
+	}
+
+	//Value held by node, nullptr if node is nullptr or holds another type
+	template<typename Value, typename Node>
+	std::conditional_t<std::is_const_v<Node>, const Value, Value>* getIf(Node* node)
+	{
+		if constexpr (!IsStdNode<std::remove_const_t<Node>>::value)
+			return boost::get<Value>(node);
+		else if constexpr (HoldsAlternative<std::remove_const_t<Node>, NodeHolder<Value>>::value)
+		{
+			auto holder = std::get_if<NodeHolder<Value>>(node);
+			return (nullptr != holder) ? &holder->get() : nullptr;
+		}
+		else
+			return std::get_if<Value>(node);
+	}
+
+	//Value held by node, throws boost::bad_get or std::bad_variant_access if it holds another type
+	template<typename Value, typename Node>
+	std::conditional_t<std::is_const_v<Node>, const Value, Value>& getValue(Node& node)
+	{
+		if constexpr (!IsStdNode<std::remove_const_t<Node>>::value)
+			return boost::get<Value>(node);
+		else if constexpr (HoldsAlternative<std::remove_const_t<Node>, NodeHolder<Value>>::value)
+			return std::get<NodeHolder<Value>>(node).get();
+		else
+			return std::get<Value>(node);
+	}
+
+	//Calls visitor with the value held by node, subtrees and arrays are passed as trees and arrays
+	template<typename Visitor, typename Node>
+	decltype(auto) visitNode(Visitor&& visitor, Node& node)
+	{
+		if constexpr (IsStdNode<std::remove_const_t<Node>>::value)
+			return std::visit([&visitor](auto& val) -> decltype(auto) { return visitor(unwrapNode(val)); }, node);
+		else
+			return boost::apply_visitor(visitor, node);
+	}
+
+	//Position of the type held by node in the list of types of the tree, subtrees first and arrays second
+	template<typename Node>
+	size_t nodeIndex(const Node& node)
+	{
+		if constexpr (IsStdNode<Node>::value)
+			return node.index();
+		else
+			return static_cast<size_t>(node.which());
+	}
 
 	template<typename KeyType, typename T, typename... Args>
-	struct Nodes;
+	using PropertyTree = BasicPropertyTree<DefaultTreePolicy, KeyType, T, Args...>;
 
 	template<typename KeyType, typename T, typename... Args>
-	using ArrayElement = boost::variant<boost::recursive_wrapper<PropertyTree<KeyType, T, Args...>>, boost::recursive_wrapper<Nodes<KeyType, T, Args...>>, T, Args...>;
+	using Nodes = BasicNodes<DefaultTreePolicy, KeyType, T, Args...>;
 
 	template<typename KeyType, typename T, typename... Args>
-	struct Nodes
+	using ArrayElement = BasicArrayElement<DefaultTreePolicy, KeyType, T, Args...>;
+
+	//True for maps offering find(key, hash), which looks a key up by a hash computed beforehand with Map::hasher
+	template<typename Map, typename Key, typename = void>
+	struct HasHashedFind : std::false_type {};
+
+	template<typename Map, typename Key>
+	struct HasHashedFind<Map, Key, std::void_t<decltype(std::declval<const Map&>().find(std::declval<const Key&>(), size_t()))>> : std::true_type {};
+
+	//True for policies declaring `static constexpr bool CacheDigests = true;`
+	template<typename Policy, typename = void>
+	struct CachesDigests : std::false_type {};
+
+	template<typename Policy>
+	struct CachesDigests<Policy, std::enable_if_t<Policy::CacheDigests>> : std::true_type {};
+
+	//Base of trees and arrays, keeps their digest between calls to digest() if the policy asks for it. Every non const
+	//member function of a tree or an array drops the cached digest, so changes made through references obtained from
+	//the tree are seen as long as the references were obtained after the last call to digest().
+	template<typename Policy, bool = CachesDigests<Policy>::value>
+	class DigestCache : public Policy::NodeBase
+	{
+	protected:
+		void invalidateDigest() {}
+
+		bool cachedDigest(uint64_t&) const
+		{
+			return false;
+		}
+
+		void cacheDigest(uint64_t) const {}
+
+	public:
+		//Whether digest() would answer without hashing
+		bool hasCachedDigest() const
+		{
+			return false;
+		}
+	};
+
+	template<typename Policy>
+	class DigestCache<Policy, true> : public Policy::NodeBase
 	{
-		typedef ULCommonUtils::ArrayElement<KeyType, T, Args...> ArrayElement;
-		typedef std::vector<ArrayElement> ArrayElements;
+		mutable std::atomic<uint64_t> m_digest;	//0 while unknown, digests are never 0
+
+	protected:
+		DigestCache() : m_digest(0) {}
+
+		DigestCache(const DigestCache& other) : m_digest(other.m_digest.load(std::memory_order_relaxed)) {}
+
+		DigestCache& operator=(const DigestCache&)
+		{
+			invalidateDigest();
+			return *this;
+		}
+
+		void invalidateDigest()
+		{
+			m_digest.store(0, std::memory_order_relaxed);
+		}
+
+		bool cachedDigest(uint64_t& digest) const
+		{
+			digest = m_digest.load(std::memory_order_relaxed);
+			return (0 != digest);
+		}
+
+		void cacheDigest(uint64_t digest) const
+		{
+			m_digest.store(digest, std::memory_order_relaxed);
+		}
+
+	public:
+		bool hasCachedDigest() const
+		{
+			return (0 != m_digest.load(std::memory_order_relaxed));
+		}
+	};
+
+	namespace
+	{
+		inline uint64_t mixDigest(uint64_t val)
+		{
+			val = (val ^ (val >> 30)) * 0xbf58476d1ce4e5b9ULL;
+			val = (val ^ (val >> 27)) * 0x94d049bb133111ebULL;
+			return val ^ (val >> 31);
+		}
+
+		inline uint64_t digestBytes(const char* data, size_t length, uint64_t seed)
+		{
+			uint64_t digest = mixDigest(seed ^ (length * 0x9e3779b97f4a7c15ULL));
+			for (; length >= 8; data += 8, length -= 8)
+			{
+				uint64_t word;
+				std::memcpy(&word, data, 8);
+				digest = mixDigest(digest ^ word) + 0x9e3779b97f4a7c15ULL;
+			}
+
+			uint64_t word = 0;
+			std::memcpy(&word, data, length);
+			return mixDigest(digest ^ word);
+		}
+
+		template<typename Container, typename = void>
+		struct HasShares : std::false_type {};
+
+		template<typename Container>
+		struct HasShares<Container, std::void_t<decltype(std::declval<const Container&>().shares(std::declval<const Container&>()))>> : std::true_type {};
+
+		template<typename Value, typename = void>
+		struct HasDigest : std::false_type {};
+
+		template<typename Value>
+		struct HasDigest<Value, std::void_t<decltype(std::declval<const Value&>().digest())>> : std::true_type {};
+
+		//Digest of one tree member or array element, equal values have equal digests
+		struct ValueDigest : boost::static_visitor<uint64_t>
+		{
+			uint64_t m_seed;
+
+			ValueDigest(uint64_t seed) : m_seed(seed) {}
+
+			template<typename Traits, typename Allocator>
+			uint64_t operator()(const std::basic_string<char, Traits, Allocator>& str) const
+			{
+				return digestBytes(str.data(), str.length(), m_seed);
+			}
+
+			uint64_t operator()(double num) const
+			{
+				//0.0 and -0.0 compare equal
+				uint64_t bits = 0;
+				if (0.0 != num)
+					std::memcpy(&bits, &num, sizeof(bits));
+
+				return mixDigest(m_seed ^ bits);
+			}
+
+			template<typename Value>
+			uint64_t operator()(const Value& val) const
+			{
+				if constexpr (std::is_integral_v<Value>)
+					return mixDigest(m_seed ^ static_cast<uint64_t>(val));
+				else if constexpr (HasDigest<Value>::value)
+					return mixDigest(m_seed ^ val.digest());
+				else
+					return mixDigest(m_seed ^ static_cast<uint64_t>(std::hash<Value>()(val)));
+			}
+		};
+
+		template<typename Variant>
+		uint64_t digestValue(const Variant& val)
+		{
+			return visitNode(ValueDigest((nodeIndex(val) + 1) * 0x9e3779b97f4a7c15ULL), val);
+		}
+
+		template<typename Key>
+		uint64_t digestKey(const Key& key)
+		{
+			if constexpr (std::is_convertible_v<const Key&, std::string_view>)
+			{
+				std::string_view str(key);
+				return digestBytes(str.data(), str.length(), 0);
+			}
+			else
+				return mixDigest(static_cast<uint64_t>(std::hash<Key>()(key)));
+		}
+	}
+
+	template<typename Policy, typename KeyType, typename T, typename... Args>
+	struct BasicNodes : DigestCache<Policy>
+	{
+		typedef BasicArrayElement<Policy, KeyType, T, Args...> ArrayElement;
+		typedef typename Policy::template Vector<ArrayElement> ArrayElements;
 
 		typedef typename ArrayElements::iterator iterator;
 		typedef typename ArrayElements::const_iterator const_iterator;
@@ -32,52 +483,59 @@ namespace ULCommonUtils
 		typedef typename ArrayElements::reverse_iterator reverse_iterator;
 		typedef typename ArrayElements::const_reverse_iterator const_reverse_iterator;
 
-		Nodes() {}
+		BasicNodes() {}
+
+		BasicNodes(const ArrayElements& elements) : m_elements(elements) {}
 
-		Nodes(const ArrayElements& elements) : m_elements(elements) {}
+		BasicNodes(ArrayElements&& elements) : m_elements(std::move(elements)) {}
 
-		Nodes(const Nodes& other) : m_elements(other.m_elements) {}
+		BasicNodes(const BasicNodes& other) : DigestCache<Policy>(other), m_elements(other.m_elements) {}
 
-		Nodes(Nodes&& other) : m_elements(other.m_elements)
+		BasicNodes(BasicNodes&& other) noexcept
 		{
-			Nodes empty;
-			swap(empty);
 			swap(other);
 		}
 
-		const Nodes& operator=(const Nodes& other)
+		const BasicNodes& operator=(const BasicNodes& other)
 		{
 			if (&other != this)
 			{
-				Nodes temp(other);
+				BasicNodes temp(other);
 				swap(temp);
 			}
 
 			return *this;
 		}
 
-		const Nodes& operator=(Nodes&& other)
+		const BasicNodes& operator=(BasicNodes&& other) noexcept
 		{
-			Nodes empty;
-			swap(empty);
-			swap(other);
+			if (&other != this)
+			{
+				BasicNodes temp(std::move(other));
+				swap(temp);
+			}
+
 			return *this;
 		}
 
-		Nodes(size_t n, const ArrayElement& initializer) : m_elements(n, initializer) {}
+		BasicNodes(size_t n, const ArrayElement& initializer) : m_elements(n, initializer) {}
 
-		void swap(Nodes& other)
+		void swap(BasicNodes& other) noexcept
 		{
+			this->invalidateDigest();
+			other.invalidateDigest();
 			m_elements.swap(other.m_elements);
 		}
 
 		iterator begin()
 		{
+			this->invalidateDigest();
 			return m_elements.begin();
 		}
 
 		iterator end()
 		{
+			this->invalidateDigest();
 			return m_elements.end();
 		}
 
@@ -93,11 +551,13 @@ namespace ULCommonUtils
 
 		reverse_iterator rbegin()
 		{
+			this->invalidateDigest();
 			return m_elements.rbegin();
 		}
 
 		reverse_iterator rend()
 		{
+			this->invalidateDigest();
 			return m_elements.rend();
 		}
 
@@ -113,11 +573,28 @@ namespace ULCommonUtils
 
 		void push_back(const ArrayElement& elem)
 		{
+			this->invalidateDigest();
 			m_elements.push_back(elem);
 		}
 
+		void push_back(ArrayElement&& elem)
+		{
+			this->invalidateDigest();
+			m_elements.push_back(std::move(elem));
+		}
+
+		//Constructs the element in place from a value of one of the element types, e.g. emplace_back(PropertyTree())
+		template<typename... ElementArgs>
+		ArrayElement& emplace_back(ElementArgs&&... args)
+		{
+			this->invalidateDigest();
+			m_elements.emplace_back(std::forward<ElementArgs>(args)...);
+			return m_elements[m_elements.size() - 1];
+		}
+
 		void pop_back()
 		{
+			this->invalidateDigest();
 			m_elements.pop_back();
 		}
 
@@ -133,16 +610,19 @@ namespace ULCommonUtils
 
 		void clear()
 		{
+			this->invalidateDigest();
 			m_elements.clear();
 		}
 
 		iterator erase(iterator it)
 		{
+			this->invalidateDigest();
 			return m_elements.erase(it);
 		}
 
 		ArrayElement& operator [](size_t index)
 		{
+			this->invalidateDigest();
 			return m_elements[index];
 		}
 
@@ -151,11 +631,29 @@ namespace ULCommonUtils
 			return m_elements[index];
 		}
 
-		bool operator ==(const Nodes& other) const
+		//Compares the contents, cached digests are not trusted here: one may predate a change made through a reference
+		//into the array, which nothing tells its ancestors about
+		bool operator ==(const BasicNodes& other) const
 		{
 			return (m_elements == other.m_elements);
 		}
 
+		//Order dependent digest of the elements, equal arrays have equal digests
+		uint64_t digest() const
+		{
+			uint64_t digest;
+			if (this->cachedDigest(digest))
+				return digest;
+
+			digest = 0x6a09e667f3bcc908ULL;
+			for (auto& elem : m_elements)
+				digest = mixDigest(digest ^ digestValue(elem)) + 0x9e3779b97f4a7c15ULL;
+
+			digest = mixDigest(digest ^ m_elements.size()) | 1;
+			this->cacheDigest(digest);
+			return digest;
+		}
+
 	private:
 		ArrayElements m_elements;
 
@@ -165,12 +663,13 @@ namespace ULCommonUtils
 	using Node = boost::variant<boost::recursive_wrapper<PropertyTree<KeyType, T, Args...>>, Nodes<KeyType, T, Args...>, T, Args...>;
 
 
-	template<typename KeyType, typename T, typename... Args>
-	struct PropertyTree
+	template<typename Policy, typename KeyType, typename T, typename... Args>
+	struct BasicPropertyTree : DigestCache<Policy>
 	{
-		typedef ULCommonUtils::Nodes<KeyType, T, Args...> Nodes;
+		typedef Policy TreePolicy;
+		typedef BasicNodes<Policy, KeyType, T, Args...> Nodes;
 		typedef typename Nodes::ArrayElement Node;
-		typedef std::unordered_map<KeyType, Node> NodeContainer;
+		typedef typename Policy::template Map<KeyType, Node> NodeContainer;
 		typedef std::vector<KeyType> Path;
 
 		typedef typename NodeContainer::iterator iterator;
@@ -178,9 +677,16 @@ namespace ULCommonUtils
 
 		Node& operator[](const KeyType& attribute)
 		{
+			this->invalidateDigest();
 			return m_data[attribute];
 		}
 
+		Node& operator[](KeyType&& attribute)
+		{
+			this->invalidateDigest();
+			return m_data[std::move(attribute)];
+		}
+
 		const Node& operator[](const KeyType& attribute) const
 		{
 			auto it = m_data.find(attribute);
@@ -196,46 +702,42 @@ namespace ULCommonUtils
 				throw std::runtime_error("Empty path provided");
 			else
 			{
-				PropertyTree* curr = const_cast<PropertyTree*>(this);
-				int i;
-				for (i = 0; i < path.size() - 1; i++)
+				BasicPropertyTree* curr = this;
+				for (size_t i = 0; i < path.size() - 1; i++)
 				{
 					auto it = curr->find(path[i]);
-					try
-					{
-						if (it == curr->end())
-							it = curr->insert({path[i], PropertyTree() }).first;
+					if (it == curr->end())
+						it = curr->try_emplace(path[i], BasicPropertyTree()).first;
 
-						try
-						{
-							curr = &boost::get<PropertyTree>(it->second);
-							continue;
-						}
-						catch (boost::bad_get) {}
+					if (auto tree = getIf<BasicPropertyTree>(&it->second))
+					{
+						curr = tree;
+						continue;
+					}
 
-						auto& nodeList = boost::get<Nodes>(it->second);
-						auto listIt = nodeList.begin();
-						for(;listIt != nodeList.end(); listIt++)
+					BasicPropertyTree* next = nullptr;
+					if (auto nodeList = getIf<Nodes>(&it->second))
+					{
+						for (auto& elem : *nodeList)
 						{
-							try
-							{
-								curr = &boost::get<PropertyTree>(*listIt);
+							if (nullptr != (next = getIf<BasicPropertyTree>(&elem)))
 								break;
-							}
-							catch(boost::bad_get){ }
 						}
-
-						if(listIt == nodeList.end())
-							throw boost::bad_get();
 					}
-					catch (boost::bad_get)
+
+					if (nullptr == next)
 					{
-						auto& nodeList = (boost::get<Nodes>(curr->insert_or_assign(path[i], Nodes{{ it->second, PropertyTree() }}).first->second));
-						curr = &boost::get<PropertyTree>(nodeList[1]);
+						Nodes nodeList;
+						nodeList.push_back(std::move(it->second));
+						nodeList.emplace_back(BasicPropertyTree());
+						it->second = std::move(nodeList);
+						next = &getValue<BasicPropertyTree>(getValue<Nodes>(it->second)[1]);
 					}
+
+					curr = next;
 				}
 
-				return (*curr)[path[i]];
+				return (*curr)[path.back()];
 			}
 		}
 
@@ -245,25 +747,108 @@ namespace ULCommonUtils
 				throw std::runtime_error("Empty path provided");
 			else
 			{
-				const PropertyTree* curr = this;
-				int i;
-				for (i = 0; i < path.size() - 1; i++)
+				const BasicPropertyTree* curr = this;
+				for (size_t i = 0; i < path.size() - 1; i++)
 				{
-					try
-					{
-						if (auto it = (*curr).find(path[i]); it == (*curr).end())
-							throw std::runtime_error("Invalid path");
-						else
-							curr =  &boost::get<PropertyTree>(it->second);
-					}
-					catch (boost::bad_get)
-					{
+					auto it = curr->find(path[i]);
+					if ((it == curr->end()) || (nullptr == (curr = getIf<BasicPropertyTree>(&it->second))))
 						throw std::runtime_error("Invalid path");
-					}
 				}
 
-				return (*curr)[path[i]];
+				return (*curr)[path.back()];
+			}
+		}
+
+		//Path whose keys are hashed once, for the same lookup repeated against many trees. Only maps offering
+		//find(key, hash), such as SmallMap, use the hashes: std::unordered_map cannot take a hash computed beforehand, so
+		//with the default policy a compiled path is looked up like any other path.
+		class CompiledPath
+		{
+			friend struct BasicPropertyTree;
+
+			std::vector<std::pair<KeyType, size_t>> m_steps;
+
+		public:
+			CompiledPath(const Path& path)
+			{
+				m_steps.reserve(path.size());
+				for (auto& key : path)
+				{
+					if constexpr (HasHashedFind<NodeContainer, KeyType>::value)
+						m_steps.emplace_back(key, typename NodeContainer::hasher()(key));
+					else
+						m_steps.emplace_back(key, 0);
+				}
+			}
+
+			size_t size() const
+			{
+				return m_steps.size();
 			}
+		};
+
+		//Non throwing lookups: every key of the path but the last one has to name a nested tree, arrays are not descended into.
+		//nullptr is returned for empty paths, absent keys and, for try_get, values of another type.
+		const Node* find_path(const Path& path) const
+		{
+			return findPath(*this, path.size(), [&path](auto& tree, size_t i) { return tree.find(path[i]); });
+		}
+
+		Node* find_path(const Path& path)
+		{
+			return findPath(*this, path.size(), [&path](auto& tree, size_t i) { return tree.find(path[i]); });
+		}
+
+		const Node* find_path(const CompiledPath& path) const
+		{
+			return findPath(*this, path.m_steps.size(), [&path](auto& tree, size_t i) { return tree.find(path.m_steps[i].first, path.m_steps[i].second); });
+		}
+
+		Node* find_path(const CompiledPath& path)
+		{
+			return findPath(*this, path.m_steps.size(), [&path](auto& tree, size_t i) { return tree.find(path.m_steps[i].first, path.m_steps[i].second); });
+		}
+
+		template<typename Value>
+		const Value* try_get(const KeyType& key) const
+		{
+			auto it = find(key);
+			return (it != end()) ? getIf<Value>(&it->second) : nullptr;
+		}
+
+		template<typename Value>
+		Value* try_get(const KeyType& key)
+		{
+			auto it = find(key);
+			return (it != end()) ? getIf<Value>(&it->second) : nullptr;
+		}
+
+		template<typename Value>
+		const Value* try_get(const Path& path) const
+		{
+			auto node = find_path(path);
+			return (nullptr != node) ? getIf<Value>(node) : nullptr;
+		}
+
+		template<typename Value>
+		Value* try_get(const Path& path)
+		{
+			auto node = find_path(path);
+			return (nullptr != node) ? getIf<Value>(node) : nullptr;
+		}
+
+		template<typename Value>
+		const Value* try_get(const CompiledPath& path) const
+		{
+			auto node = find_path(path);
+			return (nullptr != node) ? getIf<Value>(node) : nullptr;
+		}
+
+		template<typename Value>
+		Value* try_get(const CompiledPath& path)
+		{
+			auto node = find_path(path);
+			return (nullptr != node) ? getIf<Value>(node) : nullptr;
 		}
 
 		size_t size() const
@@ -278,11 +863,13 @@ namespace ULCommonUtils
 
 		iterator begin()
 		{
+			this->invalidateDigest();
 			return m_data.begin();
 		}
 
 		iterator end()
 		{
+			this->invalidateDigest();
 			return m_data.end();
 		}
 
@@ -296,81 +883,204 @@ namespace ULCommonUtils
 			return m_data.end();
 		}
 
-		iterator find(const KeyType& key)
+		iterator find(const KeyType& key)
+		{
+			this->invalidateDigest();
+			return m_data.find(key);
+		}
+
+		const_iterator find(const KeyType& key) const
+		{
+			return m_data.find(key);
+		}
+
+		//Takes a hash computed with NodeContainer::hasher, containers which cannot use it hash the key themselves
+		iterator find(const KeyType& key, size_t hash)
 		{
-			return m_data.find(key);
+			this->invalidateDigest();
+			if constexpr (HasHashedFind<NodeContainer, KeyType>::value)
+				return m_data.find(key, hash);
+			else
+				return m_data.find(key);
 		}
 
-		const_iterator find(const KeyType& key) const
+		const_iterator find(const KeyType& key, size_t hash) const
 		{
-			return m_data.find(key);
+			if constexpr (HasHashedFind<NodeContainer, KeyType>::value)
+				return m_data.find(key, hash);
+			else
+				return m_data.find(key);
 		}
 
 		iterator erase(const_iterator position)
 		{
+			this->invalidateDigest();
 			return m_data.erase(position);
 		}
 
 		size_t erase(const KeyType& key)
 		{
+			this->invalidateDigest();
 			return m_data.erase(key);
 		}
 
 		iterator erase(const_iterator first, const_iterator last)
 		{
+			this->invalidateDigest();
 			return m_data.erase(first, last);
 		}
 
 		void clear()
 		{
+			this->invalidateDigest();
 			m_data.clear();
 		}
 
 		std::pair<iterator, bool> insert(const std::pair<KeyType, Node>& val)
 		{
+			this->invalidateDigest();
 			return m_data.insert(val);
 		}
 
+		std::pair<iterator, bool> insert(std::pair<KeyType, Node>&& val)
+		{
+			this->invalidateDigest();
+			return m_data.insert(std::move(val));
+		}
+
 		std::pair<iterator, bool> insert_or_assign(const KeyType& key, const Node& val)
 		{
+			this->invalidateDigest();
 			return m_data.insert_or_assign(key, val);
 		}
 
-		PropertyTree() {}
+		std::pair<iterator, bool> insert_or_assign(const KeyType& key, Node&& val)
+		{
+			this->invalidateDigest();
+			return m_data.insert_or_assign(key, std::move(val));
+		}
+
+		//Constructs the member in place unless the key is present already
+		template<typename... NodeArgs>
+		std::pair<iterator, bool> emplace(NodeArgs&&... args)
+		{
+			this->invalidateDigest();
+			return m_data.emplace(std::forward<NodeArgs>(args)...);
+		}
+
+		//Leaves args untouched if the key is present already
+		template<typename... NodeArgs>
+		std::pair<iterator, bool> try_emplace(const KeyType& key, NodeArgs&&... args)
+		{
+			this->invalidateDigest();
+			return m_data.try_emplace(key, std::forward<NodeArgs>(args)...);
+		}
+
+		template<typename... NodeArgs>
+		std::pair<iterator, bool> try_emplace(KeyType&& key, NodeArgs&&... args)
+		{
+			this->invalidateDigest();
+			return m_data.try_emplace(std::move(key), std::forward<NodeArgs>(args)...);
+		}
+
+		BasicPropertyTree() {}
 
-		PropertyTree(const NodeContainer& init) : m_data(init) {}
+		BasicPropertyTree(const NodeContainer& init) : m_data(init) {}
 
-		PropertyTree(const PropertyTree& other) : m_data(other.m_data) {}
+		BasicPropertyTree(const BasicPropertyTree& other) : DigestCache<Policy>(other), m_data(other.m_data) {}
 
-		PropertyTree(PropertyTree&& other) noexcept
+		BasicPropertyTree(BasicPropertyTree&& other) noexcept
 		{
-			PropertyTree empty;
+			BasicPropertyTree empty;
 			swap(empty);
 			swap(other);
 		}
 
-		void swap(PropertyTree& other)
+		void swap(BasicPropertyTree& other) noexcept
 		{
+			this->invalidateDigest();
+			other.invalidateDigest();
 			m_data.swap(other.m_data);
 		}
 
-		const PropertyTree& operator=(const PropertyTree& other)
+		const BasicPropertyTree& operator=(const BasicPropertyTree& other)
+		{
+			if (&other != this)
+			{
+				BasicPropertyTree temp(other);
+				swap(temp);
+			}
+
+			return *this;
+		}
+
+		const BasicPropertyTree& operator=(BasicPropertyTree&& other) noexcept
 		{
 			if (&other != this)
 			{
-				PropertyTree temp(other);
+				BasicPropertyTree temp(std::move(other));
 				swap(temp);
 			}
 
 			return *this;
 		}
 
-		bool operator==(const PropertyTree& other) const
+		//Compares the contents, cached digests are not trusted here: one may predate a change made through a reference
+		//into the tree, which nothing tells its ancestors about
+		bool operator==(const BasicPropertyTree& other) const
 		{
 			return (m_data == other.m_data);
 		}
 
+		//True when both trees hold the very same members, as versions of a persistent tree do until one of them is changed.
+		//Unlike equal digests this cannot go stale. Always false for containers that are never shared.
+		bool sharesMembers(const BasicPropertyTree& other) const
+		{
+			if constexpr (HasShares<NodeContainer>::value)
+				return m_data.shares(other.m_data);
+			else
+				return false;
+		}
+
+		//Merkle style digest of the tree independent of the order of its members, equal trees have equal digests.
+		//Policies declaring CacheDigests keep the digest of every subtree until it is modified, so recomputing it
+		//after a change only revisits the modified paths.
+		uint64_t digest() const
+		{
+			uint64_t digest;
+			if (this->cachedDigest(digest))
+				return digest;
+
+			uint64_t members = 0;
+			for (auto& member : m_data)
+				members += mixDigest(digestKey(member.first) ^ (digestValue(member.second) * 0x9e3779b97f4a7c15ULL));
+
+			digest = mixDigest(members ^ 0xbb67ae8584caa73bULL ^ m_data.size()) | 1;
+			this->cacheDigest(digest);
+			return digest;
+		}
+
 	private:
+		//Shared by the const and the non const lookups, the latter drop the cached digest of every tree on the path
+		template<typename Self, typename Lookup>
+		static auto findPath(Self& self, size_t length, Lookup lookup) -> decltype(&self.begin()->second)
+		{
+			if (0 == length)
+				return nullptr;
+
+			auto curr = &self;
+			for (size_t i = 0;; i++)
+			{
+				auto it = lookup(*curr, i);
+				if (it == curr->end())
+					return nullptr;
+				else if (i + 1 == length)
+					return &it->second;
+				else if (nullptr == (curr = getIf<BasicPropertyTree>(&it->second)))
+					return nullptr;
+			}
+		}
+
 		NodeContainer m_data;
 	};
 
@@ -381,18 +1091,100 @@ namespace ULCommonUtils
 			return "";
 		}
 	};
-	template<typename Visitor, typename KeyType, typename T, typename... Args>
-	std::string serializeToJSon(const PropertyTree<KeyType, T, Args...>& pt);
+
+	//Output sinks for serializeToJSon, a sink only needs append(char) and append(const char*, size_t)
+
+	//Appends to a caller owned string, reusing the same string across messages keeps its capacity
+	struct StringSink
+	{
+		StringSink(std::string& buffer) : m_buffer(buffer) {}
+
+		void append(char ch)
+		{
+			m_buffer.push_back(ch);
+		}
+
+		void append(const char* data, size_t length)
+		{
+			m_buffer.append(data, length);
+		}
+
+	private:
+		std::string& m_buffer;
+	};
+
+	struct StreamSink
+	{
+		StreamSink(std::ostream& stream) : m_stream(stream) {}
+
+		void append(char ch)
+		{
+			m_stream.put(ch);
+		}
+
+		void append(const char* data, size_t length)
+		{
+			m_stream.write(data, length);
+		}
+
+	private:
+		std::ostream& m_stream;
+	};
+
+	//Writes into a fixed size buffer, throws if the output does not fit
+	struct SpanSink
+	{
+		SpanSink(char* buffer, size_t capacity) :
+			m_buffer(buffer),
+			m_capacity(capacity),
+			m_size(0)
+		{}
+
+		void append(char ch)
+		{
+			append(&ch, 1);
+		}
+
+		void append(const char* data, size_t length)
+		{
+			if (length > m_capacity - m_size)
+				throw std::runtime_error("Output buffer too small");
+
+			std::memcpy(m_buffer + m_size, data, length);
+			m_size += length;
+		}
+
+		size_t size() const
+		{
+			return m_size;
+		}
+
+		void clear()
+		{
+			m_size = 0;
+		}
+
+	private:
+		char* m_buffer;
+		size_t m_capacity;
+		size_t m_size;
+	};
+
+	template<typename Visitor, typename Sink, typename Policy, typename KeyType, typename T, typename... Args>
+	void serializeToJSon(const BasicPropertyTree<Policy, KeyType, T, Args...>& pt, Sink&& sink);
+
+	template<typename Visitor, typename Policy, typename KeyType, typename T, typename... Args>
+	std::string serializeToJSon(const BasicPropertyTree<Policy, KeyType, T, Args...>& pt);
 	
-	inline bool validateIsNumber(std::string num)
+	inline bool validateIsNumber(std::string_view num)
 	{
 		if (num.empty())
 			return false;
 
-		auto validateIntegerPart = [](std::string num, size_t start)
+		auto validateIntegerPart = [](std::string_view num, size_t start)
 		{
 			size_t end = start;
-			if (num[start] == '.')
+			if ((start == num.size()) || (num[start] == '.'))
 				return std::string::npos;
 
 			while ((end < num.size()) && (num[end] != '.'))
@@ -407,7 +1199,7 @@ namespace ULCommonUtils
 		};
 
 
-		auto validateZeroOrOneDecimalAndDoesntEndWithDecimal = [](std::string num, size_t start)
+		auto validateZeroOrOneDecimalAndDoesntEndWithDecimal = [](std::string_view num, size_t start)
 		{
 			if (start == num.length())//no decimal
 				return start;
@@ -421,7 +1213,7 @@ namespace ULCommonUtils
 				return start + 1;
 		};
 
-		auto validateIntegerToTheEnd = [](std::string num, size_t start)
+		auto validateIntegerToTheEnd = [](std::string_view num, size_t start)
 		{
 			size_t end = start;
 			while (end < num.length())
@@ -436,7 +1228,6 @@ namespace ULCommonUtils
 		};
 
 		auto res = false;
-		auto len = num.length();
 		auto start = ((num[0] == '+') || (num[0] == '-'))? 1 : 0;
 
 		auto index = validateIntegerPart(num, start);
@@ -449,318 +1240,547 @@ namespace ULCommonUtils
 		return res;
 	}
 
+	typedef ULCommonUtils::PropertyTree<std::string, std::string, char, int, long long, size_t, double> JSonPropertyTree;
+	typedef BasicPropertyTree<StdVariantTreePolicy, std::string, std::string, char, int, long long, size_t, double> StdJSonPropertyTree;
+
 	namespace
 	{
-		template<typename VisitorBase, typename Keytype, typename T, typename... Args>
-		struct JSonConversionVisitor : VisitorBase, boost::static_visitor<std::string>
+		//Locale independent formatting, finite floating point values use the shortest text that reads back to the same
+		//value and always carry a fraction or an exponent so that they are read back as floating point. Infinities and
+		//NaN are formatted as inf, -inf and nan.
+		template<typename Number>
+		size_t formatNumber(char (&buffer)[32], Number num)
 		{
-			typedef ULCommonUtils::PropertyTree<Keytype, T, Args...> PropertyTree;
-			typedef typename PropertyTree::Nodes Nodes;
-			using VisitorBase::operator();
+			auto length = static_cast<size_t>(std::to_chars(buffer, buffer + sizeof(buffer), num).ptr - buffer);
+			if constexpr (std::is_floating_point_v<Number>)
+			{
+				if (std::isfinite(num) && (buffer + length == std::find_if(buffer, buffer + length, [](char ch) { return ('.' == ch) || ('e' == ch); })))
+				{
+					buffer[length++] = '.';
+					buffer[length++] = '0';
+				}
+			}
 
-			std::string operator()(std::string str) const
+			return length;
+		}
+
+		//formatNumber for JSon output, which has no text for infinities and NaN
+		template<typename Number>
+		size_t formatJSonNumber(char (&buffer)[32], Number num)
+		{
+			auto length = formatNumber(buffer, num);
+			if constexpr (std::is_floating_point_v<Number>)
 			{
-				return '\"' + str + '\"';
+				if (!std::isfinite(num))
+					throw std::runtime_error(std::string("JSon can not represent the number ") + std::string(buffer, length));
 			}
 
-			std::string operator()(char ch) const
+			return length;
+		}
+
+		//Formats every value straight into the sink, only values produced by the user supplied visitor are validated
+		template<typename VisitorBase, typename Sink, typename PropertyTree>
+		struct JSonWriter : boost::static_visitor<void>
+		{
+			typedef typename PropertyTree::Nodes Nodes;
+
+			JSonWriter(Sink& sink) : m_sink(sink) {}
+
+			template<typename Traits, typename Allocator>
+			void operator()(const std::basic_string<char, Traits, Allocator>& str) const
 			{
-				return '\'' + std::string(1, ch) + '\'';
+				m_sink.append('\"');
+				m_sink.append(str.data(), str.length());
+				m_sink.append('\"');
 			}
 
-			std::string operator()(short num) const
+			void operator()(char ch) const
 			{
-				return std::to_string(num);
+				m_sink.append('\'');
+				m_sink.append(ch);
+				m_sink.append('\'');
 			}
 
-			std::string operator()(int num) const
+			void operator()(short num) const
 			{
-				return std::to_string(num);
+				appendNumber(num);
 			}
 
-			std::string operator()(long num) const
+			void operator()(int num) const
 			{
-				return std::to_string(num);
+				appendNumber(num);
 			}
 
-			std::string operator()(long long num) const
+			void operator()(long num) const
 			{
-				return std::to_string(num);
+				appendNumber(num);
 			}
 
-			std::string operator()(size_t num) const
+			void operator()(long long num) const
 			{
-				return std::to_string(num);
+				appendNumber(num);
 			}
 
-			std::string operator()(double num) const
+			void operator()(size_t num) const
 			{
-				return boost::lexical_cast<std::string>(num);
+				appendNumber(num);
 			}
 
-			std::string operator()(const PropertyTree& pt) const
+			void operator()(double num) const
 			{
-				return serializeToJSon<VisitorBase, Keytype, T, Args...>(pt);
+				appendNumber(num);
 			}
 
-			std::string operator()(const Nodes& nodes) const
+			void operator()(const PropertyTree& pt) const
 			{
-				std::string str;
-				str += "[";
+				m_sink.append('{');
+				for (auto it = pt.begin(); it != pt.end(); it++)
+				{
+					if (it != pt.begin())
+						m_sink.append(',');
+
+					std::string_view key(it->first);
+					m_sink.append('\"');
+					m_sink.append(key.data(), key.length());
+					m_sink.append("\":", 2);
+					visitNode(*this, it->second);
+				}
+
+				m_sink.append('}');
+			}
 
-				for (auto it = nodes.begin(); it != nodes.end();)
+			void operator()(const Nodes& nodes) const
+			{
+				m_sink.append('[');
+				for (auto it = nodes.begin(); it != nodes.end(); it++)
 				{
-					str += boost::apply_visitor(*this, (*it));
+					if (it != nodes.begin())
+						m_sink.append(',');
 
-					it++;
-					if (it != nodes.end())
-						str += ',';
-					else
-						break;
+					visitNode(*this, *it);
 				}
 
-				str += "]";
+				m_sink.append(']');
+			}
+
+			//Types without a built in format are formatted by the user supplied visitor
+			template<typename Value>
+			void operator()(const Value& val) const
+			{
+				std::string str = VisitorBase()(val);
+				if (str.empty())
+					throw std::runtime_error("Empty value provided by visitor");
+				else if ('\"' != str[0] &&
+					'\'' != str[0] &&
+					'[' != str[0] &&
+					'{' != str[0] &&
+					!validateIsNumber(str)
+					)//If this is not a string, char, a json string or an array of values, then it must be a valid number
+					throw std::runtime_error(std::string("Incorrectly formatted value provided by visitor: ") + str);
+
+				m_sink.append(str.data(), str.length());
+			}
 
-				return str;
+		private:
+			template<typename Number>
+			void appendNumber(Number num) const
+			{
+				char buffer[32];
+				m_sink.append(buffer, formatJSonNumber(buffer, num));
 			}
+
+			Sink& m_sink;
+		};
+
+		//The JSon reader fills trees of the shape BasicPropertyTree<Policy, KeyType, String, char, int, long long, size_t, double>
+		template<typename Tree>
+		struct JSonStringType;
+
+		template<typename Policy, typename KeyType, typename T, typename... Args>
+		struct JSonStringType<BasicPropertyTree<Policy, KeyType, T, Args...>>
+		{
+			typedef T type;
 		};
 
-		typedef ULCommonUtils::PropertyTree<std::string, std::string, char, int, long long, size_t, double> PropertyTree;
+		template<typename Tree>
+		void parseObject(std::string_view jsonString, size_t& start, Tree& pt);
 
-		PropertyTree deseraliseFromJSon(std::string jsonString, size_t& start);
-		PropertyTree::Nodes parseValues(std::string jsonString, size_t& start);
+		template<typename Tree>
+		void parseValues(std::string_view jsonString, size_t& start, typename Tree::Nodes& nodes);
 
-		inline PropertyTree::Node parseValue(std::string jsonString, size_t& start)
+		[[noreturn]] inline void throwMalformedJSon(std::string_view jsonString, size_t position)
 		{
-			if (jsonString[start] == '\"')
-			{
-				++start;
-				auto endIndex = jsonString.find_first_of('\"', start + 1);
-				std::string val(jsonString.c_str() + start, endIndex - start);
-				start += val.length() + 1;
-				return val;
-			}
-			else if (jsonString[start] == '\'')
-			{
-				++start;
-				auto val = jsonString[start];
-				start += 2;
-				return val;
-			}
-			else if (jsonString[start] == '{')
-				return deseraliseFromJSon(jsonString, start);
-			else if (jsonString[start] == '[')
-				return parseValues(jsonString, start);
+			if (position < jsonString.length())
+				throw std::runtime_error(std::string("Malformed JSon message, unexpected character \'") + jsonString[position] + "\' at position " + std::to_string(position));
 			else
-			{
-				bool isDecimal = false;
-				auto endNumIndex = start + 1;
-				for (auto currChar = jsonString[endNumIndex]; (0 != std::isdigit(currChar)) || ('.' == currChar); currChar = jsonString[++endNumIndex]) 
-				{
-					isDecimal = isDecimal || ('.' == jsonString[endNumIndex]);
-				}
+				throw std::runtime_error("Malformed JSon message, unexpected end of input");
+		}
 
-				std::string numStr(jsonString.c_str() + start,  endNumIndex - start);
-				start = endNumIndex;
+		inline bool isJSonWhiteSpace(char ch)
+		{
+			return (' ' == ch) || ('\n' == ch) || ('\r' == ch) || ('\t' == ch);
+		}
 
-				if (isDecimal)
-					return std::stod(numStr);
+		inline void skipWhiteSpaces(std::string_view jsonString, size_t& start)
+		{
+			while ((start < jsonString.length()) && isJSonWhiteSpace(jsonString[start]))
+				start++;
+		}
 
-				try
-				{
-					return std::stoi(numStr);
-				}
-				catch (std::out_of_range)
-				{
-					return std::stoll(numStr);
-				}
-			}
+		//Skips white spaces and returns the next character without consuming it
+		inline char peekToken(std::string_view jsonString, size_t& start)
+		{
+			skipWhiteSpaces(jsonString, start);
+			if (start >= jsonString.length())
+				throwMalformedJSon(jsonString, start);
+
+			return jsonString[start];
 		}
 
-		inline PropertyTree::Nodes parseValues(std::string jsonString, size_t& start)
+		inline void consumeToken(std::string_view jsonString, size_t& start, char expected)
 		{
-			PropertyTree::Nodes retVal;
+			if (peekToken(jsonString, start) != expected)
+				throwMalformedJSon(jsonString, start);
+
 			start++;
-			while (jsonString[start] != ']')
+		}
+
+		//Returns the characters between the quotes, escape sequences are kept as they are
+		inline std::string_view parseString(std::string_view jsonString, size_t& start)
+		{
+			size_t begin = ++start;
+			while ((start < jsonString.length()) && (jsonString[start] != '\"'))
+				start += ('\\' == jsonString[start]) ? 2 : 1;
+
+			if (start >= jsonString.length())
+				throwMalformedJSon(jsonString, jsonString.length());
+
+			return jsonString.substr(begin, start++ - begin);
+		}
+
+		inline char parseChar(std::string_view jsonString, size_t& start)
+		{
+			if ((start + 2 >= jsonString.length()) || (jsonString[start + 2] != '\''))
+				throwMalformedJSon(jsonString, start);
+
+			char val = jsonString[start + 1];
+			start += 3;
+			return val;
+		}
+
+		//Moves past the value starting at start without building it, only strings, chars and the nesting are checked
+		inline void skipJSonValue(std::string_view jsonString, size_t& start)
+		{
+			size_t length = jsonString.length();
+			switch (jsonString[start])
 			{
-				while ((jsonString[start] == ',') ||	//Skip the non-data characters
-					(jsonString[start] == ' ')
-					)
-					start++;
+			case '{':
+			case '[':
+			{
+				size_t depth = 0;
+				while (start < length)
+				{
+					switch (jsonString[start])
+					{
+					case '\"':
+						parseString(jsonString, start);
+						continue;
+					case '\'':
+						parseChar(jsonString, start);
+						continue;
+					case '{':
+					case '[':
+						depth++;
+						break;
+					case '}':
+					case ']':
+						if (0 == --depth)
+						{
+							start++;
+							return;
+						}
+						break;
+					default:
+						break;
+					}
 
-				retVal.push_back(parseValue(jsonString, start));
+					start++;
+				}
 
-				while (jsonString[start] == ' ')//skip whilte spaces at the end of the list
+				throwMalformedJSon(jsonString, length);
+			}
+			case '\"':
+				parseString(jsonString, start);
+				return;
+			case '\'':
+				parseChar(jsonString, start);
+				return;
+			default:
+				while ((start < length) && (',' != jsonString[start]) && ('}' != jsonString[start]) && (']' != jsonString[start]) && !isJSonWhiteSpace(jsonString[start]))
 					start++;
 			}
-			start++;
+		}
+
+		inline size_t skipDigits(std::string_view jsonString, size_t start)
+		{
+			while ((start < jsonString.length()) && (0 != std::isdigit(static_cast<unsigned char>(jsonString[start]))))
+				start++;
 
-			return retVal;
+			return start;
 		}
 
-		inline PropertyTree deseraliseFromJSon(std::string jsonString, size_t& start)
+		//Validates the number starting at start and moves past it. Returns its text without a leading '+', which
+		//std::from_chars does not accept, and whether it has a fraction or an exponent.
+		inline std::string_view scanNumber(std::string_view jsonString, size_t& start, bool& isFloating)
 		{
-			PropertyTree pt;
+			auto length = jsonString.length();
+			auto end = start;
+			if ((end < length) && (('-' == jsonString[end]) || ('+' == jsonString[end])))
+				end++;
 
-			std::string currKey = "";
+			auto digitsEnd = skipDigits(jsonString, end);
+			if (digitsEnd == end)
+				throwMalformedJSon(jsonString, end);
 
-			for (; start < jsonString.length(); ++start)
+			end = digitsEnd;
+			isFloating = false;
+			if ((end < length) && ('.' == jsonString[end]))
 			{
-				while ((jsonString[start] == ',') ||	//Skip the non-data characters
-					(jsonString[start] == ':') ||
-					(jsonString[start] == ' ')
-					)
-					start++;
+				isFloating = true;
+				digitsEnd = skipDigits(jsonString, ++end);
+				if (digitsEnd == end)
+					throwMalformedJSon(jsonString, end);
+
+				end = digitsEnd;
+			}
+
+			if ((end < length) && (('e' == jsonString[end]) || ('E' == jsonString[end])))
+			{
+				isFloating = true;
+				if ((++end < length) && (('-' == jsonString[end]) || ('+' == jsonString[end])))
+					end++;
+
+				digitsEnd = skipDigits(jsonString, end);
+				if (digitsEnd == end)
+					throwMalformedJSon(jsonString, end);
+
+				end = digitsEnd;
+			}
+
+			auto first = start + (('+' == jsonString[start]) ? 1 : 0);
+			start = end;
+			return jsonString.substr(first, end - first);
+		}
+
+		//Integers become the narrowest of int, long long and size_t that holds them, anything with a fraction, an exponent
+		//or beyond the integer range becomes a double. Conversion is locale independent and never throws for valid input.
+		template<typename Tree = JSonPropertyTree>
+		typename Tree::Node parseNumber(std::string_view jsonString, size_t& start)
+		{
+			bool isFloating;
+			auto num = scanNumber(jsonString, start, isFloating);
+			const char* first = num.data();
+			const char* last = num.data() + num.length();
 
-				char currentChar = jsonString[start];
-				if (currentChar == '\"')
+			if (!isFloating)
+			{
+				long long val;
+				if (std::from_chars(first, last, val).ec == std::errc())
 				{
-					auto val = boost::get<std::string>(parseValue(jsonString, start));
-					if (currKey.empty())
-						currKey = val;
+					if ((val >= std::numeric_limits<int>::min()) && (val <= std::numeric_limits<int>::max()))
+						return static_cast<int>(val);
 					else
-					{
-						pt[currKey] = val;
-						currKey = "";
-					}
-				}
-				else if (currentChar == '\'')
-				{
-					pt[currKey] = boost::get<char>(parseValue(jsonString, start));
-					currKey = "";
-				}
-				else if (currentChar == '{')
-				{
-					pt[currKey] = deseraliseFromJSon(jsonString, start);
-					currKey = "";
-				}
-				else if (currentChar == '[')
-				{
-					pt[currKey] = parseValues(jsonString, start);
-					currKey = "";
+						return val;
 				}
-				else if (isdigit(currentChar) || ('-' == currentChar) || ('+' == currentChar))
-				{
-					auto val = parseValue(jsonString, start);
-					try
-					{
-						pt[currKey] = boost::get<int>(val);
-					}
-					catch (boost::bad_get)
-					{
-						try
-						{
-							pt[currKey] = boost::get<double> (val);
-						}
-						catch (boost::bad_get)
-						{
-							pt[currKey] = boost::get<long long>(val);
-						}
-					}
 
-					currKey = "";
-				}
-				else if (currentChar == '}')
+				unsigned long long unsignedVal;
+				if (('-' != *first) && (std::from_chars(first, last, unsignedVal).ec == std::errc()) && (unsignedVal <= std::numeric_limits<size_t>::max()))
+					return static_cast<size_t>(unsignedVal);
+			}
+
+			double val;
+			if (std::from_chars(first, last, val).ec != std::errc())
+				throw std::runtime_error(std::string("Number out of range: ") + std::string(first, last));
+
+			return val;
+		}
+
+		template<typename Tree>
+		typename Tree::Node parseScalar(std::string_view jsonString, size_t& start)
+		{
+			switch (jsonString[start])
+			{
+			case '\"':
+				return typename JSonStringType<Tree>::type(parseString(jsonString, start));
+			case '\'':
+				return parseChar(jsonString, start);
+			default:
+				return parseNumber<Tree>(jsonString, start);
+			}
+		}
+
+		//Objects and arrays are parsed directly into the node that holds them so that no subtree is ever copied
+		template<typename Tree>
+		void parseValue(std::string_view jsonString, size_t& start, typename Tree::Node& val)
+		{
+			switch (peekToken(jsonString, start))
+			{
+			case '{':
+				val = Tree();
+				parseObject(jsonString, start, getValue<Tree>(val));
+				break;
+			case '[':
+				val = typename Tree::Nodes();
+				parseValues<Tree>(jsonString, start, getValue<typename Tree::Nodes>(val));
+				break;
+			default:
+				val = parseScalar<Tree>(jsonString, start);
+			}
+		}
+
+		template<typename Tree>
+		void parseValues(std::string_view jsonString, size_t& start, typename Tree::Nodes& nodes)
+		{
+			consumeToken(jsonString, start, '[');
+			if (peekToken(jsonString, start) == ']')
+			{
+				start++;
+				return;
+			}
+
+			while (true)
+			{
+				switch (peekToken(jsonString, start))
 				{
-					start++;
+				case '{':
+					parseObject(jsonString, start, getValue<Tree>(nodes.emplace_back(Tree())));
 					break;
+				case '[':
+					parseValues<Tree>(jsonString, start, getValue<typename Tree::Nodes>(nodes.emplace_back(typename Tree::Nodes())));
+					break;
+				default:
+					nodes.push_back(parseScalar<Tree>(jsonString, start));
 				}
-				else
-					throw std::runtime_error(std::string("Malformed JSon message, unexpected character \'") + currentChar + "\' at position " + std::to_string(start));
+
+				char currentChar = peekToken(jsonString, start);
+				start++;
+				if (']' == currentChar)
+					break;
+				else if (',' != currentChar)
+					throwMalformedJSon(jsonString, start - 1);
+			}
+		}
+
+		template<typename Tree>
+		void parseObject(std::string_view jsonString, size_t& start, Tree& pt)
+		{
+			consumeToken(jsonString, start, '{');
+			if (peekToken(jsonString, start) == '}')
+			{
+				start++;
+				return;
+			}
+
+			while (true)
+			{
+				if (peekToken(jsonString, start) != '\"')
+					throwMalformedJSon(jsonString, start);
+
+				auto key = parseString(jsonString, start);
+				consumeToken(jsonString, start, ':');
+				//A default constructed member would allocate an empty subtree only to replace it
+				parseValue<Tree>(jsonString, start, pt.try_emplace(typename Tree::NodeContainer::key_type(key), 0).first->second);
+
+				char currentChar = peekToken(jsonString, start);
+				start++;
+				if ('}' == currentChar)
+					break;
+				else if (',' != currentChar)
+					throwMalformedJSon(jsonString, start - 1);
 			}
+		}
 
+		template<typename Tree = JSonPropertyTree>
+		Tree deseraliseFromJSon(std::string_view jsonString, size_t& start)
+		{
+			Tree pt;
+			parseObject(jsonString, start, pt);
 			return pt;
 		}
 
+		template<typename Number>
+		void appendNumber(std::string& str, Number val)
+		{
+			char buffer[32];
+			str.append(buffer, formatNumber(buffer, val));
+		}
+
 		void operator +=(std::string& str, int val)
 		{
-			str += std::to_string(val);
+			appendNumber(str, val);
 		}
 
 		void operator +=(std::string& str, long long val)
 		{
-			str += std::to_string(val);
+			appendNumber(str, val);
 		}
 
 		void operator +=(std::string& str, float val)
 		{
-			str += std::to_string(val);
+			appendNumber(str, val);
 		}
 
 		void operator +=(std::string& str, double val)
 		{
-			str += std::to_string(val);
+			appendNumber(str, val);
 		}
 
 		std::string operator +(std::string str, int val)
 		{
-			return (str + std::to_string(val));
+			appendNumber(str, val);
+			return str;
 		}
 
 		std::string operator +(std::string str, long long val)
 		{
-			return (str + std::to_string(val));
+			appendNumber(str, val);
+			return str;
 		}
 
 		std::string operator +(std::string str, float val)
 		{
-			return (str + std::to_string(val));
+			appendNumber(str, val);
+			return str;
 		}
 
 		std::string operator +(std::string str, double val)
 		{
-			return (str + std::to_string(val));
+			appendNumber(str, val);
+			return str;
 		}
 	}
 
-	template<typename Visitor, typename KeyType, typename T, typename... Args>
-	std::string serializeToJSon(const ULCommonUtils::PropertyTree<KeyType, T, Args...>& pt)
+	template<typename Visitor, typename Sink, typename Policy, typename KeyType, typename T, typename... Args>
+	void serializeToJSon(const BasicPropertyTree<Policy, KeyType, T, Args...>& pt, Sink&& sink)
 	{
-		auto it = pt.begin();
-		std::string str;
-		str += '{';
-
-		while (it != pt.end())
-		{
-			str += '\"';
-			str += it->first;
-			str += '\"';
-			str += ':';
-			std::string valueForCurrKey = boost::apply_visitor(JSonConversionVisitor<Visitor, KeyType, T, Args...>(), it->second);
-			if ((0 == valueForCurrKey.length()))
-				throw std::runtime_error(std::string("Empty value for key: ") + it->first);
-			else if ('\"' != valueForCurrKey[0] &&
-				'\'' != valueForCurrKey[0] &&
-				'[' != valueForCurrKey[0] &&
-				'{' != valueForCurrKey[0]
-				)//If this is not a string, char, a json string or an array of values, then it must be a valid number
-			{
-				if(!validateIsNumber(valueForCurrKey))
-					throw std::runtime_error(std::string("Incorrectly formatted value provided for key: ") + it->first);
-				//if (!std::regex_match(valueForCurrKey, std::regex("[-+]?([0-9]+\.[0-9]+|[0-9]+)")))
-				//	throw std::runtime_error(std::string("Incorrectly formatted value provided for key: ") + it->first);
-			}
-
-			str += valueForCurrKey;
-
-			it++;
-			if (it != pt.end())
-				str += ',';
-			else
-				break;
-		}
-
-
-		str += '}';
+		JSonWriter<Visitor, std::remove_reference_t<Sink>, BasicPropertyTree<Policy, KeyType, T, Args...>> writer(sink);
+		writer(pt);
+	}
 
+	template<typename Visitor, typename Policy, typename KeyType, typename T, typename... Args>
+	std::string serializeToJSon(const BasicPropertyTree<Policy, KeyType, T, Args...>& pt)
+	{
+		std::string str;
+		serializeToJSon<Visitor>(pt, StringSink(str));
 		return str;
 	}
 
-
-	inline ULCommonUtils::PropertyTree<std::string, std::string, char, int, long long, size_t, double> deseraliseFromJSon(std::string jsonString)
+	//Tree may be any BasicPropertyTree<Policy, KeyType, String, char, int, long long, size_t, double>
+	template<typename Tree = JSonPropertyTree>
+	Tree deseraliseFromJSon(std::string_view jsonString)
 	{
 		size_t start = 0;
-		return deseraliseFromJSon(jsonString, start);
+		return deseraliseFromJSon<Tree>(jsonString, start);
 	}
 
 }
@@ -1,65 +1,512 @@
-#pragma once
-#include "CommonUtils/CommonDefs.hpp"
-#include <queue>
-
-namespace ULCommonUtils
-{
-	template <class T>
-	class RingBuffer
-	{
-		std::queue<T> m_queue;
-		size_t m_capacity;
-	public:
-		RingBuffer(size_t capacity) :
-			m_capacity(capacity)
-		{
-		}
-
-		void push(T item)
-		{
-			if (full())
-				pop();
-
-			m_queue.push(item);
-		}
-
-		void pop()
-		{
-			if (empty())
-				throw std::runtime_error("Trying to pop empty queue");
-
-			m_queue.pop();
-		}
-
-		size_t size()
-		{
-			return m_queue.size();
-		}
-
-		size_t empty()
-		{
-			return (size() == 0);
-		}
-
-		bool full()
-		{
-			return (size() == m_capacity);
-		}
-
-		T front()
-		{
-			if (empty())
-				throw std::runtime_error("Trying to access element when buffer is empty");
-
-			return m_queue.front();
-		}
-
-		T back()
-		{
-			if (empty())
-				throw std::runtime_error("Trying to access element when buffer is empty");
-
-			return m_queue.back();
-		}
-	};
-}
+#pragma once
+#include "CommonUtils/CommonDefs.hpp"
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace ULCommonUtils
+{
+	namespace
+	{
+		//Smallest power of two not below capacity, so that positions wrap with a mask
+		constexpr size_t ringSlots(size_t capacity)
+		{
+			size_t slots = 1;
+			while (slots < capacity)
+				slots <<= 1;
+
+			return slots;
+		}
+
+		//Slots of a buffer whose capacity is known at compile time, held inline
+		template<class T, size_t Capacity>
+		class RingStorage
+		{
+			mutable std::aligned_storage_t<sizeof(T), alignof(T)> m_slots[ringSlots(Capacity)];
+
+		protected:
+			explicit RingStorage(size_t capacity)
+			{
+				if (Capacity != capacity)
+					throw std::runtime_error("Capacity differs from the one of the buffer type");
+			}
+
+			//Inline slots cannot be handed over, the buffer copies or moves its elements
+			RingStorage(const RingStorage&) {}
+
+			RingStorage& operator=(const RingStorage&)
+			{
+				return *this;
+			}
+
+			void* slot(size_t index) const
+			{
+				return &m_slots[index & (ringSlots(Capacity) - 1)];
+			}
+
+		public:
+			constexpr size_t capacity() const
+			{
+				return Capacity;
+			}
+		};
+
+		//Slots of a buffer whose capacity is chosen at construction, allocated once
+		template<class T>
+		class RingStorage<T, 0>
+		{
+			typedef std::aligned_storage_t<sizeof(T), alignof(T)> Slot;
+
+			mutable std::unique_ptr<Slot[]> m_slots;
+			size_t m_capacity;
+			size_t m_mask;
+
+		protected:
+			explicit RingStorage(size_t capacity) :
+				m_slots(new Slot[ringSlots(capacity)]),
+				m_capacity(capacity),
+				m_mask(ringSlots(capacity) - 1)
+			{
+			}
+
+			RingStorage(const RingStorage& other) : RingStorage(other.m_capacity) {}
+
+			//Leaves other without slots, it can only be assigned to or destroyed
+			RingStorage(RingStorage&& other) noexcept :
+				m_slots(std::move(other.m_slots)),
+				m_capacity(other.m_capacity),
+				m_mask(other.m_mask)
+			{
+				other.m_capacity = 0;
+				other.m_mask = 0;
+			}
+
+			RingStorage& operator=(const RingStorage& other)
+			{
+				if (m_capacity != other.m_capacity)
+				{
+					m_slots.reset(new Slot[ringSlots(other.m_capacity)]);
+					m_capacity = other.m_capacity;
+					m_mask = ringSlots(other.m_capacity) - 1;
+				}
+
+				return *this;
+			}
+
+			void* slot(size_t index) const
+			{
+				return &m_slots[index & m_mask];
+			}
+
+			void swapSlots(RingStorage& other) noexcept
+			{
+				std::swap(m_slots, other.m_slots);
+				std::swap(m_capacity, other.m_capacity);
+				std::swap(m_mask, other.m_mask);
+			}
+
+		public:
+			size_t capacity() const
+			{
+				return m_capacity;
+			}
+		};
+
+		template<class Value, class Buffer>
+		class RingIterator
+		{
+			template<class, class>
+			friend class RingIterator;
+
+			Buffer* m_buffer;
+			size_t m_index;
+
+		public:
+			typedef std::random_access_iterator_tag iterator_category;
+			typedef std::remove_const_t<Value> value_type;
+			typedef ptrdiff_t difference_type;
+			typedef Value* pointer;
+			typedef Value& reference;
+
+			RingIterator() : m_buffer(nullptr), m_index(0) {}
+			RingIterator(Buffer* buffer, size_t index) : m_buffer(buffer), m_index(index) {}
+
+			//iterator to const_iterator
+			template<class OtherValue, class OtherBuffer, class = std::enable_if_t<std::is_convertible_v<OtherValue*, Value*>>>
+			RingIterator(const RingIterator<OtherValue, OtherBuffer>& other) : m_buffer(other.m_buffer), m_index(other.m_index) {}
+
+			reference operator*() const
+			{
+				return (*m_buffer)[m_index];
+			}
+
+			pointer operator->() const
+			{
+				return &(*m_buffer)[m_index];
+			}
+
+			reference operator[](difference_type offset) const
+			{
+				return (*m_buffer)[m_index + offset];
+			}
+
+			RingIterator& operator++()
+			{
+				m_index++;
+				return *this;
+			}
+
+			RingIterator operator++(int)
+			{
+				return RingIterator(m_buffer, m_index++);
+			}
+
+			RingIterator& operator--()
+			{
+				m_index--;
+				return *this;
+			}
+
+			RingIterator operator--(int)
+			{
+				return RingIterator(m_buffer, m_index--);
+			}
+
+			RingIterator& operator+=(difference_type offset)
+			{
+				m_index += offset;
+				return *this;
+			}
+
+			RingIterator& operator-=(difference_type offset)
+			{
+				m_index -= offset;
+				return *this;
+			}
+
+			RingIterator operator+(difference_type offset) const
+			{
+				return RingIterator(m_buffer, m_index + offset);
+			}
+
+			friend RingIterator operator+(difference_type offset, const RingIterator& it)
+			{
+				return it + offset;
+			}
+
+			RingIterator operator-(difference_type offset) const
+			{
+				return RingIterator(m_buffer, m_index - offset);
+			}
+
+			difference_type operator-(const RingIterator& other) const
+			{
+				return static_cast<difference_type>(m_index - other.m_index);
+			}
+
+			bool operator==(const RingIterator& other) const
+			{
+				return m_index == other.m_index;
+			}
+
+			bool operator!=(const RingIterator& other) const
+			{
+				return m_index != other.m_index;
+			}
+
+			bool operator<(const RingIterator& other) const
+			{
+				return m_index < other.m_index;
+			}
+
+			bool operator>(const RingIterator& other) const
+			{
+				return m_index > other.m_index;
+			}
+
+			bool operator<=(const RingIterator& other) const
+			{
+				return m_index <= other.m_index;
+			}
+
+			bool operator>=(const RingIterator& other) const
+			{
+				return m_index >= other.m_index;
+			}
+		};
+	}
+
+	//Holds the last capacity elements pushed, pushing to a full buffer drops the oldest element. The elements live in
+	//one block of slots allocated up front, or inline when the capacity is given as a template argument, and positions
+	//wrap by masking with the slot count rounded up to a power of two. Index 0 and begin() are the oldest element.
+	template <class T, size_t Capacity = 0>
+	class RingBuffer : public RingStorage<T, Capacity>
+	{
+		typedef RingStorage<T, Capacity> Storage;
+
+		size_t m_head;		//Position of the oldest element, wraps through the mask
+		size_t m_size;
+
+		T* element(size_t index) const
+		{
+			return std::launder(static_cast<T*>(this->slot(m_head + index)));
+		}
+
+		void checkNotEmpty() const
+		{
+			if (empty())
+				throw std::runtime_error("Trying to access element when buffer is empty");
+		}
+
+		//Constructs an element after the newest one, the buffer must not be full
+		template<class... Args>
+		T& emplaceBack(Args&&... args)
+		{
+			//Constructing the element could write over m_size as far as the compiler knows, it is not read back
+			size_t size = m_size;
+			auto item = new (this->slot(m_head + size)) T(std::forward<Args>(args)...);
+			m_size = size + 1;
+			return *item;
+		}
+
+	public:
+		typedef T value_type;
+		typedef T& reference;
+		typedef const T& const_reference;
+		typedef size_t size_type;
+		typedef RingIterator<T, RingBuffer> iterator;
+		typedef RingIterator<const T, const RingBuffer> const_iterator;
+
+		template<size_t Static = Capacity, class = std::enable_if_t<0 != Static>>
+		RingBuffer() :
+			Storage(Capacity),
+			m_head(0),
+			m_size(0)
+		{
+		}
+
+		RingBuffer(size_t capacity) :
+			Storage(capacity),
+			m_head(0),
+			m_size(0)
+		{
+		}
+
+		RingBuffer(const RingBuffer& other) :
+			Storage(other),
+			m_head(0),
+			m_size(0)
+		{
+			for (auto& item : other)
+				push(item);
+		}
+
+		//Buffers allocating their slots take over the slots of other, inline ones move the elements
+		RingBuffer(RingBuffer&& other) :
+			Storage(std::move(other)),
+			m_head(0),
+			m_size(0)
+		{
+			if constexpr (0 == Capacity)
+			{
+				std::swap(m_head, other.m_head);
+				std::swap(m_size, other.m_size);
+			}
+			else
+			{
+				for (auto& item : other)
+					push(std::move(item));
+
+				other.clear();
+			}
+		}
+
+		~RingBuffer()
+		{
+			clear();
+		}
+
+		RingBuffer& operator=(const RingBuffer& other)
+		{
+			if (this != &other)
+			{
+				clear();
+				Storage::operator=(other);
+				for (auto& item : other)
+					push(item);
+			}
+
+			return *this;
+		}
+
+		//Leaves other empty
+		RingBuffer& operator=(RingBuffer&& other)
+		{
+			if (this == &other)
+				return *this;
+
+			clear();
+			if constexpr (0 == Capacity)
+			{
+				this->swapSlots(other);
+				std::swap(m_head, other.m_head);
+				std::swap(m_size, other.m_size);
+			}
+			else
+			{
+				for (auto& item : other)
+					push(std::move(item));
+
+				other.clear();
+			}
+
+			return *this;
+		}
+
+		void push(const T& item)
+		{
+			emplace(item);
+		}
+
+		void push(T&& item)
+		{
+			emplace(std::move(item));
+		}
+
+		//Constructs the newest element in place and returns it
+		template<class... Args>
+		T& emplace(Args&&... args)
+		{
+			if (full())
+			{
+				//The arguments may refer to the oldest element, it is only dropped once the new one is built
+				T item(std::forward<Args>(args)...);
+				pop();
+				return emplaceBack(std::move(item));
+			}
+
+			return emplaceBack(std::forward<Args>(args)...);
+		}
+
+		//Drops the oldest element
+		void pop()
+		{
+			if (empty())
+				throw std::runtime_error("Trying to pop empty queue");
+
+			element(0)->~T();
+			m_head++;
+			m_size--;
+		}
+
+		//Drops the newest element
+		void pop_back()
+		{
+			if (empty())
+				throw std::runtime_error("Trying to pop empty queue");
+
+			element(m_size - 1)->~T();
+			m_size--;
+		}
+
+		void clear()
+		{
+			while (!empty())
+				pop();
+
+			m_head = 0;
+		}
+
+		size_t size() const
+		{
+			return m_size;
+		}
+
+		bool empty() const
+		{
+			return (size() == 0);
+		}
+
+		bool full() const
+		{
+			return (size() == this->capacity());
+		}
+
+		//Oldest element
+		T& front()
+		{
+			checkNotEmpty();
+			return *element(0);
+		}
+
+		const T& front() const
+		{
+			checkNotEmpty();
+			return *element(0);
+		}
+
+		//Newest element
+		T& back()
+		{
+			checkNotEmpty();
+			return *element(m_size - 1);
+		}
+
+		const T& back() const
+		{
+			checkNotEmpty();
+			return *element(m_size - 1);
+		}
+
+		//Element index positions after the oldest one, unchecked
+		T& operator[](size_t index)
+		{
+			return *element(index);
+		}
+
+		const T& operator[](size_t index) const
+		{
+			return *element(index);
+		}
+
+		T& at(size_t index)
+		{
+			if (index >= m_size)
+				throw std::runtime_error("Ring buffer index out of range: " + std::to_string(index));
+
+			return *element(index);
+		}
+
+		const T& at(size_t index) const
+		{
+			if (index >= m_size)
+				throw std::runtime_error("Ring buffer index out of range: " + std::to_string(index));
+
+			return *element(index);
+		}
+
+		iterator begin()
+		{
+			return iterator(this, 0);
+		}
+
+		iterator end()
+		{
+			return iterator(this, m_size);
+		}
+
+		const_iterator begin() const
+		{
+			return const_iterator(this, 0);
+		}
+
+		const_iterator end() const
+		{
+			return const_iterator(this, m_size);
+		}
+	};
+}
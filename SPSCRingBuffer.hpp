@@ -0,0 +1,194 @@
+#pragma once
+#include "CommonUtils/RingBuffer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace ULCommonUtils
+{
+	//Lock free queue handing elements from one producer thread to one consumer thread. Unlike RingBuffer a full queue
+	//refuses new elements instead of dropping the oldest one, as the oldest one may be being read.
+	//The producer owns the tail and the consumer the head, each on a cache line of its own. Each side keeps the last
+	//value it saw of the other side's index and reads the shared one only when the cached value says the queue is
+	//full or empty, so that in the steady state the lines do not bounce between cores on every element.
+	template <class T>
+	class SPSCRingBuffer
+	{
+		static constexpr size_t CacheLine = 64;
+
+		typedef std::aligned_storage_t<sizeof(T), alignof(T)> Slot;
+
+		//Read only once constructed
+		const std::unique_ptr<Slot[]> m_slots;
+		const size_t m_capacity;
+		const size_t m_mask;
+
+		//Producer side, positions grow without wrapping and are masked on access
+		alignas(CacheLine) std::atomic<size_t> m_tail;
+		size_t m_cachedHead;
+
+		//Consumer side
+		alignas(CacheLine) std::atomic<size_t> m_head;
+		size_t m_cachedTail;
+
+		T* element(size_t position) const
+		{
+			return std::launder(reinterpret_cast<T*>(&m_slots[position & m_mask]));
+		}
+
+		//Room for count more elements as far as the producer knows, refreshing its copy of the head only if needed
+		size_t freeSlots(size_t tail, size_t count)
+		{
+			size_t free = m_capacity - (tail - m_cachedHead);
+			if (free < count)
+			{
+				m_cachedHead = m_head.load(std::memory_order_acquire);
+				free = m_capacity - (tail - m_cachedHead);
+			}
+
+			return free;
+		}
+
+		size_t readySlots(size_t head, size_t count)
+		{
+			size_t ready = m_cachedTail - head;
+			if (ready < count)
+			{
+				m_cachedTail = m_tail.load(std::memory_order_acquire);
+				ready = m_cachedTail - head;
+			}
+
+			return ready;
+		}
+
+	public:
+		explicit SPSCRingBuffer(size_t capacity) :
+			m_slots(new Slot[ringSlots(capacity)]),
+			m_capacity(capacity),
+			m_mask(ringSlots(capacity) - 1),
+			m_tail(0),
+			m_cachedHead(0),
+			m_head(0),
+			m_cachedTail(0)
+		{
+		}
+
+		SPSCRingBuffer(const SPSCRingBuffer&) = delete;
+		SPSCRingBuffer& operator=(const SPSCRingBuffer&) = delete;
+
+		//No thread may be using the queue any more
+		~SPSCRingBuffer()
+		{
+			size_t tail = m_tail.load(std::memory_order_relaxed);
+			for (size_t head = m_head.load(std::memory_order_relaxed); head != tail; head++)
+				element(head)->~T();
+		}
+
+		//Producer: constructs an element at the tail, false if the queue is full
+		template<class... Args>
+		bool try_emplace(Args&&... args)
+		{
+			size_t tail = m_tail.load(std::memory_order_relaxed);
+			if (0 == freeSlots(tail, 1))
+				return false;
+
+			new (&m_slots[tail & m_mask]) T(std::forward<Args>(args)...);
+			m_tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		bool try_push(const T& item)
+		{
+			return try_emplace(item);
+		}
+
+		bool try_push(T&& item)
+		{
+			return try_emplace(std::move(item));
+		}
+
+		//Producer: copies up to count elements from first, publishing them together, and returns how many were pushed
+		template<class InputIterator>
+		size_t push_n(InputIterator first, size_t count)
+		{
+			size_t tail = m_tail.load(std::memory_order_relaxed);
+			count = std::min(count, freeSlots(tail, count));
+			for (size_t i = 0; i < count; i++, ++first)
+				new (&m_slots[(tail + i) & m_mask]) T(*first);
+
+			if (0 != count)
+				m_tail.store(tail + count, std::memory_order_release);
+
+			return count;
+		}
+
+		//Consumer: moves the element at the head to item, false if the queue is empty
+		bool try_pop(T& item)
+		{
+			size_t head = m_head.load(std::memory_order_relaxed);
+			if (0 == readySlots(head, 1))
+				return false;
+
+			auto front = element(head);
+			item = std::move(*front);
+			front->~T();
+			m_head.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+		//Consumer: moves up to count elements to out, releasing their slots together, and returns how many were popped
+		template<class OutputIterator>
+		size_t pop_n(OutputIterator out, size_t count)
+		{
+			size_t head = m_head.load(std::memory_order_relaxed);
+			count = std::min(count, readySlots(head, count));
+			for (size_t i = 0; i < count; i++, ++out)
+			{
+				auto item = element(head + i);
+				*out = std::move(*item);
+				item->~T();
+			}
+
+			if (0 != count)
+				m_head.store(head + count, std::memory_order_release);
+
+			return count;
+		}
+
+		//Consumer: element at the head, read in place, or nullptr if the queue is empty. Stays valid until pop().
+		T* front()
+		{
+			size_t head = m_head.load(std::memory_order_relaxed);
+			return (0 != readySlots(head, 1)) ? element(head) : nullptr;
+		}
+
+		//Consumer: drops the element returned by front()
+		void pop()
+		{
+			size_t head = m_head.load(std::memory_order_relaxed);
+			element(head)->~T();
+			m_head.store(head + 1, std::memory_order_release);
+		}
+
+		//Exact only when neither side is running
+		size_t size() const
+		{
+			size_t head = m_head.load(std::memory_order_acquire);
+			return m_tail.load(std::memory_order_acquire) - head;
+		}
+
+		bool empty() const
+		{
+			return (0 == size());
+		}
+
+		size_t capacity() const
+		{
+			return m_capacity;
+		}
+	};
+}
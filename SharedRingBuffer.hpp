@@ -0,0 +1,301 @@
+#pragma once
+#include "CommonUtils/RingBuffer.hpp"
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ULCommonUtils
+{
+	namespace
+	{
+		const uint64_t SharedRingMagic = 0x474e495255434c55;	//"ULCURING"
+		const uint32_t SharedRingVersion = 1;
+
+		//Start of the segment. Only sizes and positions are stored, no pointers, so that every process may map the
+		//segment at its own address.
+		struct SharedRingHeader
+		{
+			std::atomic<uint64_t> m_magic;		//Stored last by the writer creating the segment
+			uint32_t m_version;
+			uint32_t m_elementSize;
+			uint64_t m_slots;
+
+			//Count of elements ever published, the next one goes to slot m_published & (m_slots - 1)
+			alignas(64) std::atomic<uint64_t> m_published;
+		};
+
+		//An element with its sequence, 2 * position + 1 while the writer is copying it and 2 * position + 2 once it is
+		//complete. Readers check it before and after copying the element.
+		template<class T>
+		struct SharedRingSlot
+		{
+			std::atomic<uint64_t> m_sequence;
+			T m_value;
+		};
+
+		std::string systemError(const std::string& what, const std::string& path)
+		{
+			return what + " " + path + ": " + std::strerror(errno);
+		}
+
+		//File mapped into this process, unmapped and closed on destruction. A writable segment creates the file, or sizes
+		//it when it is empty.
+		class SharedSegment
+		{
+			int m_fd;
+			void* m_address;
+			size_t m_size;
+			bool m_created;		//The file was empty and sized by this segment
+
+		public:
+			SharedSegment(const std::string& path, bool writable, size_t size) :
+				m_fd(-1),
+				m_address(MAP_FAILED),
+				m_size(0),
+				m_created(false)
+			{
+				m_fd = ::open(path.c_str(), writable ? (O_RDWR | O_CREAT) : O_RDONLY, 0644);
+				if (-1 == m_fd)
+					throw std::runtime_error(systemError("Unable to open shared ring", path));
+
+				struct stat status;
+				if (-1 == ::fstat(m_fd, &status))
+				{
+					::close(m_fd);
+					throw std::runtime_error(systemError("Unable to stat shared ring", path));
+				}
+
+				m_size = static_cast<size_t>(status.st_size);
+				if (writable && (0 == m_size))
+				{
+					if (-1 == ::ftruncate(m_fd, static_cast<off_t>(size)))
+					{
+						::close(m_fd);
+						throw std::runtime_error(systemError("Unable to size shared ring", path));
+					}
+
+					m_size = size;
+					m_created = true;
+				}
+
+				if (m_size < sizeof(SharedRingHeader))
+				{
+					::close(m_fd);
+					throw std::runtime_error("Not a shared ring: " + path);
+				}
+
+				m_address = ::mmap(nullptr, m_size, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, m_fd, 0);
+				if (MAP_FAILED == m_address)
+				{
+					::close(m_fd);
+					throw std::runtime_error(systemError("Unable to map shared ring", path));
+				}
+			}
+
+			SharedSegment(const SharedSegment&) = delete;
+			SharedSegment& operator=(const SharedSegment&) = delete;
+
+			~SharedSegment()
+			{
+				::munmap(m_address, m_size);
+				::close(m_fd);
+			}
+
+			void* address() const
+			{
+				return m_address;
+			}
+
+			size_t size() const
+			{
+				return m_size;
+			}
+
+			bool created() const
+			{
+				return m_created;
+			}
+		};
+
+		template<class T>
+		size_t sharedRingBytes(uint64_t slots)
+		{
+			return sizeof(SharedRingHeader) + slots * sizeof(SharedRingSlot<T>);
+		}
+
+		//Checks the header of an existing segment against the element type and the size of the mapping
+		template<class T>
+		void checkSharedRing(const SharedRingHeader& header, size_t size, const std::string& path)
+		{
+			if (SharedRingMagic != header.m_magic.load(std::memory_order_acquire))
+				throw std::runtime_error("Not a shared ring or not initialised yet: " + path);
+
+			if (SharedRingVersion != header.m_version)
+				throw std::runtime_error("Unsupported shared ring version " + std::to_string(header.m_version) + ": " + path);
+
+			if ((sizeof(T) != header.m_elementSize) || (0 == header.m_slots) || (0 != (header.m_slots & (header.m_slots - 1))) || (size < sharedRingBytes<T>(header.m_slots)))
+				throw std::runtime_error("Shared ring layout does not match the element type: " + path);
+		}
+	}
+
+	enum class SharedRingRead
+	{
+		Read,		//The next element was copied out
+		Empty,		//Nothing published after the reader's position yet
+		Lapped		//The writer overwrote the reader's position, catchUp() moves on to what is left
+	};
+
+	//Publishing side of a ring of trivially copyable elements in a file mapped by several processes, a file under
+	//the /dev/shm tmpfs keeps it off disk. There is one writer, which never waits for readers: like RingBuffer, a full
+	//ring drops the oldest element. Opening an existing ring keeps its capacity and continues after what was published
+	//in it, any other non empty file is refused without writing to it. POSIX only. The file is left in place on destruction so that readers stay attached, removing it is up to
+	//the application.
+	template <class T>
+	class SharedRingWriter
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Elements of a shared ring are copied as bytes");
+		static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared ring positions need lock free atomics");
+
+		SharedSegment m_segment;
+		SharedRingHeader* m_header;
+		SharedRingSlot<T>* m_slots;
+		uint64_t m_mask;
+		uint64_t m_next;
+
+	public:
+		SharedRingWriter(const std::string& path, size_t capacity) :
+			m_segment(path, true, sharedRingBytes<T>(ringSlots(capacity))),
+			m_header(static_cast<SharedRingHeader*>(m_segment.address())),
+			m_slots(reinterpret_cast<SharedRingSlot<T>*>(m_header + 1))
+		{
+			if (m_segment.created())
+			{
+				m_header->m_version = SharedRingVersion;
+				m_header->m_elementSize = sizeof(T);
+				m_header->m_slots = ringSlots(capacity);
+				m_header->m_published.store(0, std::memory_order_relaxed);
+				m_header->m_magic.store(SharedRingMagic, std::memory_order_release);
+			}
+
+			checkSharedRing<T>(*m_header, m_segment.size(), path);
+			m_mask = m_header->m_slots - 1;
+			m_next = m_header->m_published.load(std::memory_order_relaxed);
+		}
+
+		void push(const T& item)
+		{
+			auto& slot = m_slots[m_next & m_mask];
+			slot.m_sequence.store(2 * m_next + 1, std::memory_order_relaxed);
+			//Readers that see the new contents see the odd sequence too
+			std::atomic_thread_fence(std::memory_order_release);
+			std::memcpy(&slot.m_value, &item, sizeof(T));
+			slot.m_sequence.store(2 * m_next + 2, std::memory_order_release);
+			m_header->m_published.store(++m_next, std::memory_order_release);
+		}
+
+		uint64_t published() const
+		{
+			return m_next;
+		}
+
+		size_t capacity() const
+		{
+			return m_mask + 1;
+		}
+	};
+
+	//Consuming side, any number of readers may follow one ring, each at its own position. The segment is mapped
+	//read only.
+	template <class T>
+	class SharedRingReader
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Elements of a shared ring are copied as bytes");
+
+		SharedSegment m_segment;
+		const SharedRingHeader* m_header;
+		const SharedRingSlot<T>* m_slots;
+		uint64_t m_mask;
+		uint64_t m_position;
+
+		//Position of the oldest element not overwritten yet, the writer may be about to overwrite it
+		uint64_t oldest() const
+		{
+			uint64_t published = m_header->m_published.load(std::memory_order_acquire);
+			return (published > m_mask + 1) ? published - (m_mask + 1) : 0;
+		}
+
+	public:
+		//Starts after what is already published, or at the oldest element still in the ring
+		explicit SharedRingReader(const std::string& path, bool fromOldest = false) :
+			m_segment(path, false, 0),
+			m_header(static_cast<const SharedRingHeader*>(m_segment.address())),
+			m_slots(reinterpret_cast<const SharedRingSlot<T>*>(m_header + 1))
+		{
+			checkSharedRing<T>(*m_header, m_segment.size(), path);
+			m_mask = m_header->m_slots - 1;
+			m_position = fromOldest ? oldest() : m_header->m_published.load(std::memory_order_acquire);
+		}
+
+		SharedRingRead try_read(T& item)
+		{
+			uint64_t published = m_header->m_published.load(std::memory_order_acquire);
+			if (m_position >= published)
+				return SharedRingRead::Empty;
+
+			if (published - m_position > m_mask + 1)
+				return SharedRingRead::Lapped;
+
+			auto& slot = m_slots[m_position & m_mask];
+			uint64_t sequence = slot.m_sequence.load(std::memory_order_acquire);
+			if (2 * m_position + 2 != sequence)
+				return SharedRingRead::Lapped;
+
+			//The copy may be torn if the writer comes round meanwhile, the sequence tells and it is then discarded
+			T copy;
+			std::memcpy(&copy, &slot.m_value, sizeof(T));
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (sequence != slot.m_sequence.load(std::memory_order_relaxed))
+				return SharedRingRead::Lapped;
+
+			item = copy;
+			m_position++;
+			return SharedRingRead::Read;
+		}
+
+		//Moves a lapped reader to the oldest element still in the ring, returns how many elements it missed
+		uint64_t catchUp()
+		{
+			uint64_t first = oldest();
+			if (m_position >= first)
+				return 0;
+
+			uint64_t missed = first - m_position;
+			m_position = first;
+			return missed;
+		}
+
+		//Published elements not read yet, more than capacity() once lapped
+		uint64_t available() const
+		{
+			return m_header->m_published.load(std::memory_order_acquire) - m_position;
+		}
+
+		uint64_t position() const
+		{
+			return m_position;
+		}
+
+		size_t capacity() const
+		{
+			return m_mask + 1;
+		}
+	};
+}
@@ -0,0 +1,260 @@
+#pragma once
+#include "CommonUtils/CommonDefs.hpp"
+#include "CommonUtils/RingBuffer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+namespace ULCommonUtils
+{
+	//Statistics over the last capacity values pushed, and when a span is given only over those pushed within the span
+	//of the newest one. Values live in a RingBuffer, sum, mean and variance are updated as values enter and leave it and
+	//min and max are the fronts of monotonic queues, so that every push and query is O(1) amortised.
+	//Taking values back out of the running mean and variance leaves rounding errors that build up over long streams, so
+	//both are recomputed from the window once the updates since the last time outnumber twice the capacity.
+	template <class T = double>
+	class SlidingWindow
+	{
+		struct Sample
+		{
+			T m_value;
+			time_point m_at;
+		};
+
+		//Candidates for the min or the max, by position of the value in the stream
+		struct Extreme
+		{
+			uint64_t m_position;
+			T m_value;
+		};
+
+		RingBuffer<Sample> m_window;
+		RingBuffer<Extreme> m_minima;		//Increasing values, the front is the min
+		RingBuffer<Extreme> m_maxima;		//Decreasing values, the front is the max
+		duration m_span;					//Zero for windows bounded by count only
+		uint64_t m_pushed;
+
+		//Compensated sum, and Welford's running mean and sum of squared deviations
+		double m_sum;
+		double m_compensation;
+		double m_mean;
+		double m_squares;
+		size_t m_updates;		//Values added or removed since the statistics were recomputed
+
+		void addToSum(double value)
+		{
+			double sum = m_sum + value;
+			if (std::abs(m_sum) >= std::abs(value))
+				m_compensation += (m_sum - sum) + value;
+			else
+				m_compensation += (value - sum) + m_sum;
+
+			m_sum = sum;
+		}
+
+		void add(double value, size_t count)
+		{
+			m_updates++;
+			addToSum(value);
+			double delta = value - m_mean;
+			m_mean += delta / count;
+			m_squares += delta * (value - m_mean);
+		}
+
+		//count is the number of values left
+		void remove(double value, size_t count)
+		{
+			if (0 == count)
+			{
+				m_sum = m_compensation = m_mean = m_squares = 0;
+				return;
+			}
+
+			m_updates++;
+			addToSum(-value);
+			double delta = value - m_mean;
+			m_mean -= delta / count;
+			m_squares -= delta * (value - m_mean);
+		}
+
+		//Sum, mean and variance from the values in the window, in two passes
+		void recompute()
+		{
+			m_sum = m_compensation = m_mean = m_squares = 0;
+			m_updates = 0;
+			if (empty())
+				return;
+
+			for (auto& sample : m_window)
+				addToSum(static_cast<double>(sample.m_value));
+
+			m_mean = sum() / size();
+			for (auto& sample : m_window)
+				m_squares += (static_cast<double>(sample.m_value) - m_mean) * (static_cast<double>(sample.m_value) - m_mean);
+		}
+
+		//Drops the oldest value with the extremes it still backs
+		void popOldest()
+		{
+			uint64_t position = m_pushed - m_window.size();
+			remove(static_cast<double>(m_window.front().m_value), m_window.size() - 1);
+			m_window.pop();
+			if (!m_minima.empty() && (position == m_minima.front().m_position))
+				m_minima.pop();
+
+			if (!m_maxima.empty() && (position == m_maxima.front().m_position))
+				m_maxima.pop();
+		}
+
+		void checkNotEmpty() const
+		{
+			if (empty())
+				throw std::runtime_error("Trying to access element when window is empty");
+		}
+
+	public:
+		explicit SlidingWindow(size_t capacity) :
+			SlidingWindow(duration::zero(), capacity)
+		{
+		}
+
+		//At most capacity values, none older than span before the newest one
+		SlidingWindow(duration span, size_t capacity) :
+			m_window(capacity),
+			m_minima(capacity),
+			m_maxima(capacity),
+			m_span(span),
+			m_pushed(0),
+			m_sum(0),
+			m_compensation(0),
+			m_mean(0),
+			m_squares(0),
+			m_updates(0)
+		{
+		}
+
+		//Timed by now() in windows with a span
+		void push(const T& value)
+		{
+			push(value, (duration::zero() == m_span) ? time_point() : now());
+		}
+
+		void push(const T& value, time_point at)
+		{
+			if (0 == m_window.capacity())
+				return;
+
+			expire(at);
+			if (m_window.full())
+				popOldest();
+
+			while (!m_minima.empty() && !(m_minima.back().m_value < value))
+				m_minima.pop_back();
+
+			while (!m_maxima.empty() && !(value < m_maxima.back().m_value))
+				m_maxima.pop_back();
+
+			m_minima.push(Extreme{ m_pushed, value });
+			m_maxima.push(Extreme{ m_pushed, value });
+			m_window.push(Sample{ value, at });
+			m_pushed++;
+			add(static_cast<double>(value), m_window.size());
+			if (m_updates > 2 * m_window.capacity())
+				recompute();
+		}
+
+		//Drops the values pushed more than span before at, so that queries without a push in between see the window
+		//as of at. Nothing to do for windows bounded by count only.
+		void expire(time_point at = now())
+		{
+			if (duration::zero() == m_span)
+				return;
+
+			while (!m_window.empty() && (m_window.front().m_at < at - m_span))
+				popOldest();
+		}
+
+		void clear()
+		{
+			m_window.clear();
+			m_minima.clear();
+			m_maxima.clear();
+			m_sum = m_compensation = m_mean = m_squares = 0;
+			m_updates = 0;
+		}
+
+		size_t size() const
+		{
+			return m_window.size();
+		}
+
+		bool empty() const
+		{
+			return m_window.empty();
+		}
+
+		size_t capacity() const
+		{
+			return m_window.capacity();
+		}
+
+		duration span() const
+		{
+			return m_span;
+		}
+
+		double sum() const
+		{
+			return m_sum + m_compensation;
+		}
+
+		double mean() const
+		{
+			return m_mean;
+		}
+
+		//Population variance, 0 for an empty window
+		double variance() const
+		{
+			return empty() ? 0 : std::max(0.0, m_squares) / size();
+		}
+
+		//Unbiased estimate from a sample, 0 below two values
+		double sampleVariance() const
+		{
+			return (size() < 2) ? 0 : std::max(0.0, m_squares) / (size() - 1);
+		}
+
+		double stddev() const
+		{
+			return std::sqrt(variance());
+		}
+
+		const T& min() const
+		{
+			checkNotEmpty();
+			return m_minima.front().m_value;
+		}
+
+		const T& max() const
+		{
+			checkNotEmpty();
+			return m_maxima.front().m_value;
+		}
+
+		//Oldest value still in the window
+		const T& front() const
+		{
+			checkNotEmpty();
+			return m_window.front().m_value;
+		}
+
+		//Newest value
+		const T& back() const
+		{
+			checkNotEmpty();
+			return m_window.back().m_value;
+		}
+	};
+}
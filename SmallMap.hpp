@@ -0,0 +1,355 @@
+#pragma once
+#include "CommonUtils/PropertyTree.hpp"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace ULCommonUtils
+{
+	//Associative container for the small objects that make up most documents. The elements live contiguously in one
+	//vector; up to Threshold elements are searched linearly without hashing, beyond that an open addressing index of
+	//element positions is kept alongside. Like std::unordered_map the iteration order is unspecified, erasing moves the
+	//last element into the hole so `it = erase(it)` visits every remaining element.
+	//Unlike std::unordered_map, references to elements are no better than iterators: inserting may move every element
+	//to a larger vector, and erasing moves the last one, so neither may be held across an insert or an erase.
+	//Keys must not be modified through iterators.
+	template<typename Key, typename Value, size_t Threshold = 8, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>, typename Allocator = std::allocator<std::pair<Key, Value>>>
+	class SmallMap
+	{
+	public:
+		typedef Key key_type;
+		typedef Value mapped_type;
+		typedef std::pair<Key, Value> value_type;
+		typedef size_t size_type;
+		typedef Hash hasher;
+
+	private:
+		typedef std::vector<value_type, Allocator> Elements;
+		typedef std::vector<uint32_t, typename std::allocator_traits<Allocator>::template rebind_alloc<uint32_t>> Slots;
+
+		Elements m_elements;
+		Slots m_slots;		//Position + 1 of the element hashed to a slot, 0 for free slots, empty while the map is small
+
+	public:
+		typedef typename Elements::iterator iterator;
+		typedef typename Elements::const_iterator const_iterator;
+
+	private:
+		size_t slotMask() const
+		{
+			return m_slots.size() - 1;
+		}
+
+		size_t findSlot(const Key& key, size_t hash) const
+		{
+			for (size_t slot = hash & slotMask();; slot = (slot + 1) & slotMask())
+			{
+				if ((0 == m_slots[slot]) || KeyEqual()(m_elements[m_slots[slot] - 1].first, key))
+					return slot;
+			}
+		}
+
+		size_t findLinear(const Key& key) const
+		{
+			for (size_t pos = 0; pos < m_elements.size(); pos++)
+			{
+				if (KeyEqual()(m_elements[pos].first, key))
+					return pos;
+			}
+
+			return m_elements.size();
+		}
+
+		size_t findHashed(const Key& key, size_t hash) const
+		{
+			auto slot = findSlot(key, hash);
+			return (0 == m_slots[slot]) ? m_elements.size() : m_slots[slot] - 1;
+		}
+
+		size_t findPosition(const Key& key) const
+		{
+			return m_slots.empty() ? findLinear(key) : findHashed(key, Hash()(key));
+		}
+
+		size_t findPosition(const Key& key, size_t hash) const
+		{
+			return m_slots.empty() ? findLinear(key) : findHashed(key, hash);
+		}
+
+		void rebuildIndex()
+		{
+			if (m_elements.size() <= Threshold)
+			{
+				m_slots.clear();
+				return;
+			}
+
+			size_t slots = 16;
+			while (slots < 2 * m_elements.size())
+				slots *= 2;
+
+			m_slots.assign(slots, 0);
+			for (size_t pos = 0; pos < m_elements.size(); pos++)
+				m_slots[findSlot(m_elements[pos].first, Hash()(m_elements[pos].first))] = static_cast<uint32_t>(pos + 1);
+		}
+
+		//Records the element just appended at the back
+		void indexBack()
+		{
+			if (m_slots.empty() && (m_elements.size() <= Threshold))
+				return;
+
+			if (m_slots.size() < 2 * m_elements.size())
+				rebuildIndex();
+			else
+				m_slots[findSlot(m_elements.back().first, Hash()(m_elements.back().first))] = static_cast<uint32_t>(m_elements.size());
+		}
+
+		//Removes a slot keeping every probe sequence intact (backward shift deletion)
+		void eraseSlot(size_t slot)
+		{
+			for (size_t next = (slot + 1) & slotMask(); 0 != m_slots[next]; next = (next + 1) & slotMask())
+			{
+				size_t home = Hash()(m_elements[m_slots[next] - 1].first) & slotMask();
+				if (((next - home) & slotMask()) >= ((next - slot) & slotMask()))
+				{
+					m_slots[slot] = m_slots[next];
+					slot = next;
+				}
+			}
+
+			m_slots[slot] = 0;
+		}
+
+		template<typename K, typename... ValueArgs>
+		std::pair<iterator, bool> emplaceKey(K&& key, ValueArgs&&... args)
+		{
+			if (m_slots.empty())
+			{
+				auto pos = findLinear(key);
+				if (pos != m_elements.size())
+					return { m_elements.begin() + pos, false };
+			}
+			else
+			{
+				auto slot = findSlot(key, Hash()(key));
+				if (0 != m_slots[slot])
+					return { m_elements.begin() + (m_slots[slot] - 1), false };
+				else if (m_slots.size() >= 2 * (m_elements.size() + 1))
+				{
+					m_elements.emplace_back(std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)), std::forward_as_tuple(std::forward<ValueArgs>(args)...));
+					m_slots[slot] = static_cast<uint32_t>(m_elements.size());
+					return { m_elements.end() - 1, true };
+				}
+			}
+
+			m_elements.emplace_back(std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)), std::forward_as_tuple(std::forward<ValueArgs>(args)...));
+			indexBack();
+			return { m_elements.end() - 1, true };
+		}
+
+	public:
+		SmallMap() {}
+
+		SmallMap(std::initializer_list<value_type> init)
+		{
+			for (auto& val : init)
+				insert(val);
+		}
+
+		iterator begin()
+		{
+			return m_elements.begin();
+		}
+
+		iterator end()
+		{
+			return m_elements.end();
+		}
+
+		const_iterator begin() const
+		{
+			return m_elements.begin();
+		}
+
+		const_iterator end() const
+		{
+			return m_elements.end();
+		}
+
+		size_t size() const
+		{
+			return m_elements.size();
+		}
+
+		bool empty() const
+		{
+			return m_elements.empty();
+		}
+
+		void reserve(size_t n)
+		{
+			m_elements.reserve(n);
+		}
+
+		void clear()
+		{
+			m_elements.clear();
+			m_slots.clear();
+		}
+
+		iterator find(const Key& key)
+		{
+			return m_elements.begin() + findPosition(key);
+		}
+
+		const_iterator find(const Key& key) const
+		{
+			return m_elements.begin() + findPosition(key);
+		}
+
+		//Looks the key up by a hash computed beforehand with hasher, e.g. once for a lookup repeated against many maps
+		iterator find(const Key& key, size_t hash)
+		{
+			return m_elements.begin() + findPosition(key, hash);
+		}
+
+		const_iterator find(const Key& key, size_t hash) const
+		{
+			return m_elements.begin() + findPosition(key, hash);
+		}
+
+		size_t count(const Key& key) const
+		{
+			return (findPosition(key) != m_elements.size()) ? 1 : 0;
+		}
+
+		Value& operator[](const Key& key)
+		{
+			return emplaceKey(key).first->second;
+		}
+
+		Value& operator[](Key&& key)
+		{
+			return emplaceKey(std::move(key)).first->second;
+		}
+
+		std::pair<iterator, bool> insert(const value_type& val)
+		{
+			return emplaceKey(val.first, val.second);
+		}
+
+		std::pair<iterator, bool> insert(value_type&& val)
+		{
+			return emplaceKey(std::move(val.first), std::move(val.second));
+		}
+
+		template<typename... Args>
+		std::pair<iterator, bool> emplace(Args&&... args)
+		{
+			value_type val(std::forward<Args>(args)...);
+			return emplaceKey(std::move(val.first), std::move(val.second));
+		}
+
+		template<typename... Args>
+		std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args)
+		{
+			return emplaceKey(key, std::forward<Args>(args)...);
+		}
+
+		template<typename... Args>
+		std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args)
+		{
+			return emplaceKey(std::move(key), std::forward<Args>(args)...);
+		}
+
+		template<typename M>
+		std::pair<iterator, bool> insert_or_assign(const Key& key, M&& val)
+		{
+			auto res = emplaceKey(key, std::forward<M>(val));
+			if (!res.second)
+				res.first->second = std::forward<M>(val);
+
+			return res;
+		}
+
+		iterator erase(const_iterator position)
+		{
+			size_t pos = position - m_elements.begin();
+			size_t last = m_elements.size() - 1;
+			if (!m_slots.empty())
+			{
+				eraseSlot(findSlot(m_elements[pos].first, Hash()(m_elements[pos].first)));
+				if (pos != last)
+					m_slots[findSlot(m_elements[last].first, Hash()(m_elements[last].first))] = static_cast<uint32_t>(pos + 1);
+			}
+
+			if (pos != last)
+				m_elements[pos] = std::move(m_elements[last]);
+
+			m_elements.pop_back();
+			return m_elements.begin() + pos;
+		}
+
+		iterator erase(const_iterator first, const_iterator last)
+		{
+			size_t pos = first - m_elements.begin();
+			m_elements.erase(first, last);
+			rebuildIndex();
+			return m_elements.begin() + pos;
+		}
+
+		size_t erase(const Key& key)
+		{
+			auto pos = findPosition(key);
+			if (pos == m_elements.size())
+				return 0;
+
+			erase(m_elements.begin() + pos);
+			return 1;
+		}
+
+		void swap(SmallMap& other)
+		{
+			m_elements.swap(other.m_elements);
+			m_slots.swap(other.m_slots);
+		}
+
+		bool operator==(const SmallMap& other) const
+		{
+			if (size() != other.size())
+				return false;
+
+			for (auto& val : m_elements)
+			{
+				auto it = other.find(val.first);
+				if ((it == other.end()) || !(it->second == val.second))
+					return false;
+			}
+
+			return true;
+		}
+
+		bool operator!=(const SmallMap& other) const
+		{
+			return !(*this == other);
+		}
+	};
+
+	//Stores the members of every tree in a SmallMap. A reference to a member, such as the one pt["a"] returns, does not
+	//survive adding or erasing another member of the same tree; nested trees and arrays are held on the heap and stay put.
+	struct FlatTreePolicy
+	{
+		template<typename Key, typename Value>
+		using Map = SmallMap<Key, Value>;
+
+		template<typename Value>
+		using Vector = std::vector<Value>;
+
+		struct NodeBase {};
+	};
+
+	typedef BasicPropertyTree<FlatTreePolicy, std::string, std::string, char, int, long long, size_t, double> FlatPropertyTree;
+}
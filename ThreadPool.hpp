@@ -0,0 +1,85 @@
+#pragma once
+#include "CommonUtils/CommonDefs.hpp"
+#include <functional>
+#include <future>
+#include <queue>
+#include <vector>
+
+namespace ULCommonUtils
+{
+	//Fixed set of threads running submitted tasks in submission order. Destroying the pool runs the tasks still queued
+	//before joining the threads.
+	class ThreadPool
+	{
+		std::vector<stdThread> m_threads;
+		std::queue<std::function<void()>> m_tasks;
+		stdMutex m_mutex;
+		stdConditionVariable m_condition;
+		bool m_stopping;
+
+		void run()
+		{
+			while (true)
+			{
+				std::function<void()> task;
+				{
+					stdUniqueLock lock(m_mutex);
+					m_condition.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+					if (m_tasks.empty())
+						return;
+
+					task = std::move(m_tasks.front());
+					m_tasks.pop();
+				}
+
+				task();
+			}
+		}
+
+	public:
+		explicit ThreadPool(size_t threads = std::thread::hardware_concurrency()) :
+			m_stopping(false)
+		{
+			if (0 == threads)
+				threads = 1;
+
+			for (size_t i = 0; i < threads; i++)
+				m_threads.emplace_back([this]() { run(); });
+		}
+
+		~ThreadPool()
+		{
+			{
+				stdUniqueLock lock(m_mutex);
+				m_stopping = true;
+			}
+
+			m_condition.notify_all();
+			for (auto& thread : m_threads)
+				thread.join();
+		}
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		size_t size() const
+		{
+			return m_threads.size();
+		}
+
+		//The future holds the result of the task or the exception it threw
+		template<typename Task>
+		auto submit(Task task) -> std::future<decltype(task())>
+		{
+			auto packaged = std::make_shared<std::packaged_task<decltype(task())()>>(std::move(task));
+			auto future = packaged->get_future();
+			{
+				stdUniqueLock lock(m_mutex);
+				m_tasks.emplace([packaged]() { (*packaged)(); });
+			}
+
+			m_condition.notify_one();
+			return future;
+		}
+	};
+}
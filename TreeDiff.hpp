@@ -0,0 +1,151 @@
+#pragma once
+#include "CommonUtils/PropertyTree.hpp"
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace ULCommonUtils
+{
+	//Default containers, with every tree and array keeping its digest until it is modified
+	struct DigestTreePolicy
+	{
+		static constexpr bool CacheDigests = true;
+
+		template<typename Key, typename Value>
+		using Map = std::unordered_map<Key, Value>;
+
+		template<typename Value>
+		using Vector = std::vector<Value>;
+
+		struct NodeBase {};
+	};
+
+	typedef BasicPropertyTree<DigestTreePolicy, std::string, std::string, char, int, long long, size_t, double> DigestPropertyTree;
+
+	//One change of a patch. Arrays are values as a whole: a changed array is replaced, not patched element by element.
+	template<typename Tree>
+	struct TreePatchOperation
+	{
+		enum class Kind
+		{
+			Add,
+			Remove,
+			Replace
+		};
+
+		Kind m_kind;
+		typename Tree::Path m_path;
+		std::optional<typename Tree::Node> m_value;	//Empty for Remove
+	};
+
+	template<typename Tree>
+	using TreePatch = std::vector<TreePatchOperation<Tree>>;
+
+	namespace
+	{
+		template<typename Tree>
+		void diffTrees(const Tree& from, const Tree& to, typename Tree::Path& path, TreePatch<Tree>& patch);
+
+		template<typename Tree>
+		void diffValues(const typename Tree::Node& from, const typename Tree::Node& to, typename Tree::Path& path, TreePatch<Tree>& patch)
+		{
+			auto fromTree = getIf<Tree>(&from);
+			auto toTree = getIf<Tree>(&to);
+			if ((nullptr != fromTree) && (nullptr != toTree))
+			{
+				//Cached digests are not trusted, one may predate a change made through a reference into the subtree
+				if (!fromTree->sharesMembers(*toTree))
+					diffTrees(*fromTree, *toTree, path, patch);
+			}
+			else if (!(from == to))
+				patch.push_back({ TreePatchOperation<Tree>::Kind::Replace, path, to });
+		}
+
+		template<typename Tree>
+		void diffTrees(const Tree& from, const Tree& to, typename Tree::Path& path, TreePatch<Tree>& patch)
+		{
+			for (auto& member : from)
+			{
+				path.push_back(member.first);
+				auto it = to.find(member.first);
+				if (it == to.end())
+					patch.push_back({ TreePatchOperation<Tree>::Kind::Remove, path, std::nullopt });
+				else
+					diffValues<Tree>(member.second, it->second, path, patch);
+
+				path.pop_back();
+			}
+
+			for (auto& member : to)
+			{
+				if (from.find(member.first) == from.end())
+				{
+					path.push_back(member.first);
+					patch.push_back({ TreePatchOperation<Tree>::Kind::Add, path, member.second });
+					path.pop_back();
+				}
+			}
+		}
+
+		[[noreturn]] inline void throwPatchMismatch(const char* reason)
+		{
+			throw std::runtime_error(std::string("Patch does not apply, ") + reason);
+		}
+	}
+
+	//Changes turning from into to. Subtrees still shared by two versions of a persistent tree are skipped in O(1), so
+	//diffing such versions costs about the size of the change; other trees are compared member by member.
+	template<typename Tree>
+	TreePatch<Tree> diff(const Tree& from, const Tree& to)
+	{
+		TreePatch<Tree> patch;
+		typename Tree::Path path;
+		diffTrees(from, to, path, patch);
+		return patch;
+	}
+
+	//Applies a patch made by diff() to a tree equal to its from tree, the cost is proportional to the patch.
+	//Throws if the tree does not match: an operation on a missing parent, removing or replacing an absent key, or adding
+	//a present one. Operations before the mismatch stay applied.
+	template<typename Tree>
+	void applyPatch(Tree& pt, const TreePatch<Tree>& patch)
+	{
+		typedef TreePatchOperation<Tree> Operation;
+		for (auto& operation : patch)
+		{
+			auto& path = operation.m_path;
+			if (path.empty())
+				throwPatchMismatch("empty path");
+
+			Tree* parent = &pt;
+			for (size_t i = 0; i + 1 < path.size(); i++)
+			{
+				if (nullptr == (parent = parent->template try_get<Tree>(path[i])))
+					throwPatchMismatch("missing parent");
+			}
+
+			auto it = parent->find(path.back());
+			switch (operation.m_kind)
+			{
+			case Operation::Kind::Add:
+				if (it != parent->end())
+					throwPatchMismatch("added key already present");
+
+				parent->insert({ path.back(), *operation.m_value });
+				break;
+			case Operation::Kind::Remove:
+				if (it == parent->end())
+					throwPatchMismatch("removed key absent");
+
+				parent->erase(it);
+				break;
+			case Operation::Kind::Replace:
+				if (it == parent->end())
+					throwPatchMismatch("replaced key absent");
+
+				it->second = *operation.m_value;
+				break;
+			}
+		}
+	}
+}
@@ -0,0 +1,516 @@
+#pragma once
+#include "CommonUtils/PropertyTree.hpp"
+#include <algorithm>
+#include <charconv>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ULCommonUtils
+{
+	namespace
+	{
+		enum class QueryStepKind
+		{
+			Path,			//Members of nested trees, one key per level
+			Wildcard,		//Every member of a tree or element of an array
+			Index,			//Element of an array, negative indices count from the end
+			Slice,			//Elements [start, end) of an array, bounds as for Index
+			Filter			//Trees among the members or elements whose member satisfies a test
+		};
+
+		enum class QueryOperator
+		{
+			Exists,
+			Equal,
+			NotEqual,
+			Less,
+			LessEqual,
+			Greater,
+			GreaterEqual
+		};
+
+		template<typename Tree>
+		struct QueryStep
+		{
+			QueryStepKind m_kind;
+			bool m_descendants;								//Selects from the node and every node below it as well
+			typename Tree::Path m_keys;						//Path and Filter
+			std::optional<typename Tree::CompiledPath> m_path;
+			long long m_start;								//Index and Slice
+			long long m_end;
+			bool m_hasStart;
+			bool m_hasEnd;
+			QueryOperator m_operator;						//Filter
+			bool m_isNumber;
+			double m_number;
+			std::string m_string;
+		};
+
+		template<typename Value>
+		bool compareQueryValues(QueryOperator op, const Value& lhs, const Value& rhs)
+		{
+			switch (op)
+			{
+			case QueryOperator::Equal:
+				return lhs == rhs;
+			case QueryOperator::NotEqual:
+				return lhs != rhs;
+			case QueryOperator::Less:
+				return lhs < rhs;
+			case QueryOperator::LessEqual:
+				return lhs <= rhs;
+			case QueryOperator::Greater:
+				return lhs > rhs;
+			case QueryOperator::GreaterEqual:
+				return lhs >= rhs;
+			default:
+				return true;
+			}
+		}
+
+		//Compares a member against the literal of a filter. Numbers compare with numbers, strings with strings and chars
+		//with one character strings; everything else fails the test.
+		template<typename Tree>
+		struct QueryComparison : boost::static_visitor<bool>
+		{
+			const QueryStep<Tree>& m_step;
+
+			QueryComparison(const QueryStep<Tree>& step) : m_step(step) {}
+
+			template<typename Value>
+			bool operator()(const Value& val) const
+			{
+				if constexpr (std::is_same_v<Value, char>)
+					return !m_step.m_isNumber && (1 == m_step.m_string.length()) && compareQueryValues(m_step.m_operator, val, m_step.m_string[0]);
+				else if constexpr (std::is_arithmetic_v<Value>)
+					return m_step.m_isNumber && compareQueryValues(m_step.m_operator, static_cast<double>(val), m_step.m_number);
+				else if constexpr (std::is_convertible_v<const Value&, std::string_view>)
+					return !m_step.m_isNumber && compareQueryValues(m_step.m_operator, std::string_view(val), std::string_view(m_step.m_string));
+				else
+					return false;
+			}
+		};
+	}
+
+	//Query in a subset of JSONPath, compiled once and run against many trees:
+	//	$				the tree the query runs against, every query starts with it
+	//	.key ['key']	member of a tree, keys in brackets may be quoted with ' or " and hold any character
+	//	.* [*]			every member of a tree or element of an array
+	//	[n]				element of an array, negative indices count from the end
+	//	[start:end]		elements of an array from start up to end, either bound may be left out
+	//	..				prefixed to any of the above, selects from every node below as well: $..id, $..[0]
+	//	[?(@.key)]		trees among the members or elements having a member at the path @.key
+	//	[?(@.key op literal)] the same, with the member comparing to a number or a quoted string, op being one of
+	//					== != < <= > >=
+	//Consecutive keys are looked up as one compiled path. Matches are reported in document order as references into the
+	//tree, which stay valid until the tree is modified.
+	template<typename Tree = JSonPropertyTree>
+	class TreeQuery
+	{
+		typedef typename Tree::Node Node;
+		typedef typename Tree::Nodes Nodes;
+		typedef typename Tree::Path::value_type Key;
+		typedef QueryStep<Tree> Step;
+
+		std::vector<Step> m_steps;
+
+		[[noreturn]] static void throwMalformedQuery(std::string_view query, size_t position)
+		{
+			if (position < query.length())
+				throw std::runtime_error(std::string("Malformed query, unexpected character \'") + query[position] + "\' at position " + std::to_string(position));
+			else
+				throw std::runtime_error("Malformed query, unexpected end of input");
+		}
+
+		static void skipSpaces(std::string_view query, size_t& start)
+		{
+			while ((start < query.length()) && (' ' == query[start]))
+				start++;
+		}
+
+		static void consume(std::string_view query, size_t& start, char expected)
+		{
+			skipSpaces(query, start);
+			if ((start >= query.length()) || (expected != query[start]))
+				throwMalformedQuery(query, start);
+
+			start++;
+		}
+
+		static bool isNameCharacter(char ch)
+		{
+			return ((ch >= 'a') && (ch <= 'z')) || ((ch >= 'A') && (ch <= 'Z')) || ((ch >= '0') && (ch <= '9')) || ('_' == ch) || ('-' == ch) || ('$' == ch);
+		}
+
+		static std::string parseName(std::string_view query, size_t& start)
+		{
+			size_t begin = start;
+			while ((start < query.length()) && isNameCharacter(query[start]))
+				start++;
+
+			if (begin == start)
+				throwMalformedQuery(query, start);
+
+			return std::string(query.substr(begin, start - begin));
+		}
+
+		//'...' or "...", a backslash takes the next character as it is
+		static std::string parseQuoted(std::string_view query, size_t& start)
+		{
+			char quote = query[start++];
+			std::string str;
+			while (true)
+			{
+				if (start >= query.length())
+					throwMalformedQuery(query, start);
+
+				char ch = query[start++];
+				if (quote == ch)
+					return str;
+				else if ('\\' == ch)
+				{
+					if (start >= query.length())
+						throwMalformedQuery(query, start);
+
+					ch = query[start++];
+				}
+
+				str += ch;
+			}
+		}
+
+		static bool parseInteger(std::string_view query, size_t& start, long long& val)
+		{
+			skipSpaces(query, start);
+			auto result = std::from_chars(query.data() + start, query.data() + query.length(), val);
+			if (result.ec != std::errc())
+				return false;
+
+			start = result.ptr - query.data();
+			return true;
+		}
+
+		static bool isQuote(std::string_view query, size_t start)
+		{
+			return (start < query.length()) && (('\'' == query[start]) || ('\"' == query[start]));
+		}
+
+		//@.key.key['key'] op literal
+		static void parseFilter(std::string_view query, size_t& start, Step& step)
+		{
+			consume(query, start, '@');
+			while ((start < query.length()) && (('.' == query[start]) || ('[' == query[start])))
+			{
+				if ('.' == query[start++])
+					step.m_keys.push_back(Key(parseName(query, start)));
+				else
+				{
+					skipSpaces(query, start);
+					if (!isQuote(query, start))
+						throwMalformedQuery(query, start);
+
+					step.m_keys.push_back(Key(parseQuoted(query, start)));
+					consume(query, start, ']');
+				}
+			}
+
+			if (step.m_keys.empty())
+				throwMalformedQuery(query, start);
+
+			skipSpaces(query, start);
+			static const std::pair<std::string_view, QueryOperator> Operators[] = { { "==", QueryOperator::Equal }, { "!=", QueryOperator::NotEqual },
+				{ "<=", QueryOperator::LessEqual }, { ">=", QueryOperator::GreaterEqual }, { "<", QueryOperator::Less }, { ">", QueryOperator::Greater } };
+
+			step.m_operator = QueryOperator::Exists;
+			for (auto& op : Operators)
+			{
+				if (query.substr(start, op.first.length()) == op.first)
+				{
+					step.m_operator = op.second;
+					start += op.first.length();
+					break;
+				}
+			}
+
+			if (QueryOperator::Exists == step.m_operator)
+				return;
+
+			skipSpaces(query, start);
+			if (isQuote(query, start))
+			{
+				step.m_isNumber = false;
+				step.m_string = parseQuoted(query, start);
+				return;
+			}
+
+			auto result = std::from_chars(query.data() + start, query.data() + query.length(), step.m_number);
+			if (result.ec != std::errc())
+				throwMalformedQuery(query, start);
+
+			step.m_isNumber = true;
+			start = result.ptr - query.data();
+		}
+
+		//Whatever follows [
+		static void parseBracket(std::string_view query, size_t& start, Step& step)
+		{
+			skipSpaces(query, start);
+			if (start >= query.length())
+				throwMalformedQuery(query, start);
+
+			if ('*' == query[start])
+			{
+				start++;
+				step.m_kind = QueryStepKind::Wildcard;
+			}
+			else if (isQuote(query, start))
+			{
+				step.m_kind = QueryStepKind::Path;
+				step.m_keys.push_back(Key(parseQuoted(query, start)));
+			}
+			else if ('?' == query[start])
+			{
+				start++;
+				step.m_kind = QueryStepKind::Filter;
+				consume(query, start, '(');
+				parseFilter(query, start, step);
+				consume(query, start, ')');
+			}
+			else
+			{
+				step.m_kind = QueryStepKind::Index;
+				step.m_hasStart = parseInteger(query, start, step.m_start);
+				skipSpaces(query, start);
+				if ((start < query.length()) && (':' == query[start]))
+				{
+					start++;
+					step.m_kind = QueryStepKind::Slice;
+					step.m_hasEnd = parseInteger(query, start, step.m_end);
+				}
+				else if (!step.m_hasStart)
+					throwMalformedQuery(query, start);
+			}
+
+			consume(query, start, ']');
+		}
+
+		void parse(std::string_view query)
+		{
+			size_t start = 0;
+			consume(query, start, '$');
+			while (start < query.length())
+			{
+				Step step{ QueryStepKind::Path, false, {}, {}, 0, 0, false, false, QueryOperator::Exists, false, 0.0, {} };
+				if ('.' == query[start])
+				{
+					start++;
+					if ((start < query.length()) && ('.' == query[start]))
+					{
+						start++;
+						step.m_descendants = true;
+					}
+
+					if ((start < query.length()) && ('*' == query[start]))
+					{
+						start++;
+						step.m_kind = QueryStepKind::Wildcard;
+					}
+					else if (step.m_descendants && (start < query.length()) && ('[' == query[start]))
+						parseBracket(query, ++start, step);
+					else
+						step.m_keys.push_back(Key(parseName(query, start)));
+				}
+				else if ('[' == query[start])
+					parseBracket(query, ++start, step);
+				else
+					throwMalformedQuery(query, start);
+
+				//$.a.b['c'] is one lookup of the path a/b/c
+				if ((QueryStepKind::Path == step.m_kind) && !step.m_descendants && !m_steps.empty() && (QueryStepKind::Path == m_steps.back().m_kind))
+					m_steps.back().m_keys.push_back(std::move(step.m_keys.back()));
+				else
+					m_steps.push_back(std::move(step));
+			}
+
+			if (m_steps.empty())
+				throwMalformedQuery(query, start);
+
+			for (auto& step : m_steps)
+			{
+				if (!step.m_keys.empty())
+					step.m_path.emplace(step.m_keys);
+			}
+		}
+
+		//Tests never modify the tree, even when the query runs against a mutable one
+		static bool test(const Step& step, const Node& node)
+		{
+			auto tree = getIf<Tree>(&node);
+			if (nullptr == tree)
+				return false;
+
+			auto member = tree->find_path(*step.m_path);
+			if (nullptr == member)
+				return false;
+
+			return (QueryOperator::Exists == step.m_operator) || visitNode(QueryComparison<Tree>(step), *member);
+		}
+
+		template<typename NodeT, typename Callback>
+		void matchNode(NodeT& node, size_t step, Callback& callback) const
+		{
+			if (step == m_steps.size())
+				callback(node);
+			else
+				descend(node, step, callback);
+		}
+
+		template<typename TreeT, typename Callback>
+		void selectMembers(TreeT& tree, const Step& current, size_t step, Callback& callback) const
+		{
+			switch (current.m_kind)
+			{
+			case QueryStepKind::Path:
+				if (auto node = tree.find_path(*current.m_path))
+					matchNode(*node, step + 1, callback);
+
+				break;
+
+			case QueryStepKind::Wildcard:
+				for (auto it = tree.begin(); it != tree.end(); it++)
+					matchNode(it->second, step + 1, callback);
+
+				break;
+
+			case QueryStepKind::Filter:
+				for (auto it = tree.begin(); it != tree.end(); it++)
+				{
+					if (test(current, it->second))
+						matchNode(it->second, step + 1, callback);
+				}
+
+				break;
+
+			default:
+				break;
+			}
+		}
+
+		template<typename NodesT, typename Callback>
+		void selectElements(NodesT& nodes, const Step& current, size_t step, Callback& callback) const
+		{
+			long long size = static_cast<long long>(nodes.size());
+			auto bound = [size](long long index)
+			{
+				return std::clamp((index < 0) ? index + size : index, 0LL, size);
+			};
+
+			switch (current.m_kind)
+			{
+			case QueryStepKind::Wildcard:
+				for (auto it = nodes.begin(); it != nodes.end(); it++)
+					matchNode(*it, step + 1, callback);
+
+				break;
+
+			case QueryStepKind::Index:
+			{
+				long long index = (current.m_start < 0) ? current.m_start + size : current.m_start;
+				if ((index >= 0) && (index < size))
+					matchNode(nodes[static_cast<size_t>(index)], step + 1, callback);
+
+				break;
+			}
+
+			case QueryStepKind::Slice:
+				for (long long i = current.m_hasStart ? bound(current.m_start) : 0, end = current.m_hasEnd ? bound(current.m_end) : size; i < end; i++)
+					matchNode(nodes[static_cast<size_t>(i)], step + 1, callback);
+
+				break;
+
+			case QueryStepKind::Filter:
+				for (auto it = nodes.begin(); it != nodes.end(); it++)
+				{
+					if (test(current, *it))
+						matchNode(*it, step + 1, callback);
+				}
+
+				break;
+
+			default:
+				break;
+			}
+		}
+
+		template<typename NodeT, typename Callback>
+		void descend(NodeT& node, size_t step, Callback& callback) const
+		{
+			if (auto tree = getIf<Tree>(&node))
+				applyStep(*tree, step, callback);
+			else if (auto nodes = getIf<Nodes>(&node))
+				applyStep(*nodes, step, callback);
+		}
+
+		template<typename Container, typename Callback>
+		void applyStep(Container& container, size_t step, Callback& callback) const
+		{
+			auto& current = m_steps[step];
+			if constexpr (std::is_same_v<std::remove_const_t<Container>, Tree>)
+			{
+				selectMembers(container, current, step, callback);
+				if (current.m_descendants)
+				{
+					for (auto it = container.begin(); it != container.end(); it++)
+						descend(it->second, step, callback);
+				}
+			}
+			else
+			{
+				selectElements(container, current, step, callback);
+				if (current.m_descendants)
+				{
+					for (auto it = container.begin(); it != container.end(); it++)
+						descend(*it, step, callback);
+				}
+			}
+		}
+
+	public:
+		//Throws std::runtime_error if query is malformed
+		explicit TreeQuery(std::string_view query)
+		{
+			parse(query);
+		}
+
+		//Calls callback with every matching node
+		template<typename Callback>
+		void forEach(const Tree& pt, Callback&& callback) const
+		{
+			applyStep(pt, 0, callback);
+		}
+
+		//As above, the nodes may be modified through the references passed to callback but not added or removed
+		template<typename Callback>
+		void forEach(Tree& pt, Callback&& callback) const
+		{
+			applyStep(pt, 0, callback);
+		}
+
+		std::vector<const Node*> select(const Tree& pt) const
+		{
+			std::vector<const Node*> matches;
+			forEach(pt, [&matches](const Node& node) { matches.push_back(&node); });
+			return matches;
+		}
+
+		std::vector<Node*> select(Tree& pt) const
+		{
+			std::vector<Node*> matches;
+			forEach(pt, [&matches](Node& node) { matches.push_back(&node); });
+			return matches;
+		}
+	};
+}
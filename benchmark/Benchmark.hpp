@@ -0,0 +1,175 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ULCommonUtils
+{
+	namespace Benchmark
+	{
+		//Number of heap allocations made by the process so far, counted by the operator new replacements in main.cpp
+		size_t allocationCount();
+
+		//Number of bytes requested from the heap by the process so far
+		size_t allocatedBytes();
+
+		//Keeps the compiler from optimising away a computed value
+		template<typename T>
+		inline void doNotOptimize(const T& val)
+		{
+#if defined(_MSC_VER)
+			static volatile const void* sink;
+			sink = &val;
+#else
+			asm volatile("" : : "r,m"(val) : "memory");
+#endif
+		}
+
+		struct Options
+		{
+			double m_minSeconds = 0.25;
+			std::string m_filter;
+			bool m_csv = false;
+			bool m_checkOnly = false;	//Runs the checks of the suites without timing anything
+		};
+
+		struct Result
+		{
+			std::string m_name;
+			size_t m_operations;
+			size_t m_bytesPerOperation;
+			double m_megaBytesPerSecond;
+			double m_allocationsPerOperation;
+			double m_allocatedBytesPerOperation;
+			double m_meanNs;
+			double m_p50Ns;
+			double m_p99Ns;
+		};
+
+		//Times an operation repeatedly for at least the configured time and reports one line per benchmark:
+		//throughput over the bytes the operation processes, heap allocations and allocated bytes per operation and the p50/p99 latency.
+		//Operations too short to be timed one by one are timed in batches, the latency then is the batch time per operation.
+		//Suites may also check properties the numbers rely on, a failed check makes the program exit with an error.
+		class Runner
+		{
+			Options m_options;
+			size_t m_reported;
+			size_t m_failures;
+
+			void report(const Result& result)
+			{
+				if (m_options.m_csv)
+				{
+					if (0 == m_reported)
+						std::printf("benchmark,operations,bytes_per_op,mb_per_s,allocs_per_op,alloc_bytes_per_op,mean_ns,p50_ns,p99_ns\n");
+
+					std::printf("%s,%zu,%zu,%.2f,%.2f,%.1f,%.1f,%.1f,%.1f\n", result.m_name.c_str(), result.m_operations, result.m_bytesPerOperation,
+						result.m_megaBytesPerSecond, result.m_allocationsPerOperation, result.m_allocatedBytesPerOperation, result.m_meanNs, result.m_p50Ns, result.m_p99Ns);
+				}
+				else
+				{
+					std::printf("{\"benchmark\":\"%s\",\"operations\":%zu,\"bytes_per_op\":%zu,\"mb_per_s\":%.2f,\"allocs_per_op\":%.2f,\"alloc_bytes_per_op\":%.1f,\"mean_ns\":%.1f,\"p50_ns\":%.1f,\"p99_ns\":%.1f}\n",
+						result.m_name.c_str(), result.m_operations, result.m_bytesPerOperation, result.m_megaBytesPerSecond,
+						result.m_allocationsPerOperation, result.m_allocatedBytesPerOperation, result.m_meanNs, result.m_p50Ns, result.m_p99Ns);
+				}
+
+				std::fflush(stdout);
+				m_reported++;
+			}
+
+		public:
+			Runner(const Options& options) :
+				m_options(options),
+				m_reported(0),
+				m_failures(0)
+			{
+			}
+
+			//Reports a failed check on stderr, name is filtered like a benchmark name
+			void check(const std::string& name, bool passed)
+			{
+				if (!selected(name))
+					return;
+
+				if (!passed)
+				{
+					std::fprintf(stderr, "Check failed: %s\n", name.c_str());
+					m_failures++;
+				}
+			}
+
+			size_t failures() const
+			{
+				return m_failures;
+			}
+
+			bool selected(const std::string& name) const
+			{
+				return m_options.m_filter.empty() || (std::string::npos != name.find(m_options.m_filter));
+			}
+
+			//bytesPerOperation may be 0 for operations without a meaningful input size
+			template<typename Operation>
+			void run(const std::string& name, size_t bytesPerOperation, size_t batch, Operation&& operation)
+			{
+				if (!selected(name) || m_options.m_checkOnly)
+					return;
+
+				typedef std::chrono::steady_clock Clock;
+				operation();
+
+				std::vector<double> samples;
+				samples.reserve(1 << 16);
+				size_t allocations = 0, bytes = 0;
+				double totalNs = 0;
+				auto deadline = Clock::now() + std::chrono::duration<double>(m_options.m_minSeconds);
+				while ((samples.size() < 16) || ((Clock::now() < deadline) && (samples.size() < samples.capacity())))
+				{
+					auto allocationsBefore = allocationCount();
+					auto bytesBefore = allocatedBytes();
+					auto start = Clock::now();
+					for (size_t i = 0; i < batch; i++)
+						operation();
+
+					auto ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+					allocations += allocationCount() - allocationsBefore;
+					bytes += allocatedBytes() - bytesBefore;
+					totalNs += ns;
+					samples.push_back(ns / batch);
+				}
+
+				size_t operations = samples.size() * batch;
+				std::sort(samples.begin(), samples.end());
+				report({ name, operations, bytesPerOperation,
+					(0 == bytesPerOperation) ? 0.0 : (static_cast<double>(bytesPerOperation) * operations * 1e3 / totalNs),
+					static_cast<double>(allocations) / operations,
+					static_cast<double>(bytes) / operations,
+					totalNs / operations,
+					samples[samples.size() / 2],
+					samples[std::min(samples.size() - 1, samples.size() * 99 / 100)] });
+			}
+		};
+
+		typedef void (*Suite)(Runner&);
+
+		inline std::vector<std::pair<const char*, Suite>>& suites()
+		{
+			static std::vector<std::pair<const char*, Suite>> registered;
+			return registered;
+		}
+
+		//Registers a suite from a static object in the translation unit defining it
+		struct SuiteRegistrar
+		{
+			SuiteRegistrar(const char* name, Suite suite)
+			{
+				suites().emplace_back(name, suite);
+			}
+		};
+	}
+}
@@ -0,0 +1,69 @@
+#include "Benchmark.hpp"
+#include "Corpora.hpp"
+#include "CommonUtils/BinaryCodec.hpp"
+
+using namespace ULCommonUtils;
+using namespace ULCommonUtils::Benchmark;
+
+namespace
+{
+	//Visits every value of an encoded message in place, the lazy counterpart of decoding it
+	size_t walk(const BinaryValue& value)
+	{
+		switch (value.type())
+		{
+		case BinaryType::Tree:
+		{
+			size_t visited = 1;
+			for (auto member : value.members())
+				visited += member.first.length() + walk(member.second);
+
+			return visited;
+		}
+		case BinaryType::Array:
+		{
+			size_t visited = 1;
+			for (auto element : value.elements())
+				visited += walk(element);
+
+			return visited;
+		}
+		case BinaryType::String:
+			return value.asString().length();
+		default:
+			return 1;
+		}
+	}
+
+	//Same corpora as the json suite, compare binary_encode with serialize and binary_decode with parse
+	void binarySuite(Runner& runner)
+	{
+		for (auto& corpus : standardCorpora())
+		{
+			auto pt = deseraliseFromJSon(corpus.m_json);
+			std::string message;
+			serializeToBinary(pt, StringSink(message));
+			runner.check("binary_roundtrip/" + corpus.m_name, deseraliseFromBinary(message) == pt);
+
+			runner.run("binary_encode/" + corpus.m_name, message.length(), 1, [&pt, &message]()
+			{
+				message.clear();
+				serializeToBinary(pt, StringSink(message));
+				doNotOptimize(message.data());
+			});
+
+			runner.run("binary_decode/" + corpus.m_name, message.length(), 1, [&message]()
+			{
+				auto decoded = deseraliseFromBinary(message);
+				doNotOptimize(decoded.size());
+			});
+
+			runner.run("binary_walk/" + corpus.m_name, message.length(), 1, [&message]()
+			{
+				doNotOptimize(walk(binaryRoot(message)));
+			});
+		}
+	}
+
+	SuiteRegistrar binary("binary", binarySuite);
+}
@@ -0,0 +1,87 @@
+#include "Benchmark.hpp"
+#include "Corpora.hpp"
+#include "CommonUtils/JSonBinding.hpp"
+
+using namespace ULCommonUtils;
+using namespace ULCommonUtils::Benchmark;
+
+namespace
+{
+	//The schema of repeatedSchema()
+	struct Order
+	{
+		int m_id;
+		std::string m_sym;
+		char m_side;
+		double m_px;
+		int m_qty;
+		std::string m_venue;
+	};
+
+	struct Orders
+	{
+		std::vector<Order> m_orders;
+	};
+}
+
+namespace ULCommonUtils
+{
+	template<>
+	struct JSonBinding<Order>
+	{
+		static constexpr auto fields = std::make_tuple(jsonField("id", &Order::m_id), jsonField("sym", &Order::m_sym), jsonField("side", &Order::m_side),
+			jsonField("px", &Order::m_px), jsonField("qty", &Order::m_qty), jsonField("venue", &Order::m_venue));
+	};
+
+	template<>
+	struct JSonBinding<Orders>
+	{
+		static constexpr auto fields = std::make_tuple(jsonField("orders", &Orders::m_orders));
+	};
+}
+
+namespace
+{
+	//Filling structs of a known schema straight from the text against parsing a tree and pulling the fields out of it
+	void bindingSuite(Runner& runner)
+	{
+		auto json = repeatedSchema(1000);
+		runner.run("binding_parse/struct", json.length(), 1, [&json]()
+		{
+			doNotOptimize(deseraliseStructFromJSon<Orders>(json).m_orders.size());
+		});
+
+		runner.run("binding_parse/tree", json.length(), 1, [&json]()
+		{
+			auto pt = deseraliseFromJSon(json);
+			Orders orders;
+			for (auto& node : boost::get<JSonPropertyTree::Nodes>(pt["orders"]))
+			{
+				auto& order = boost::get<JSonPropertyTree>(node);
+				orders.m_orders.push_back({ boost::get<int>(order["id"]), boost::get<std::string>(order["sym"]), boost::get<char>(order["side"]),
+					boost::get<double>(order["px"]), boost::get<int>(order["qty"]), boost::get<std::string>(order["venue"]) });
+			}
+
+			doNotOptimize(orders.m_orders.size());
+		});
+
+		auto orders = deseraliseStructFromJSon<Orders>(json);
+		std::string out;
+		runner.run("binding_serialize/struct", json.length(), 1, [&orders, &out]()
+		{
+			out.clear();
+			serializeStructToJSon(orders, StringSink(out));
+			doNotOptimize(out.data());
+		});
+
+		auto pt = deseraliseFromJSon(json);
+		runner.run("binding_serialize/tree", json.length(), 1, [&pt, &out]()
+		{
+			out.clear();
+			serializeToJSon<NullVisitor>(pt, StringSink(out));
+			doNotOptimize(out.data());
+		});
+	}
+
+	SuiteRegistrar binding("binding", bindingSuite);
+}
@@ -0,0 +1,99 @@
+#include "Benchmark.hpp"
+#include "CommonUtils/ConcurrentTree.hpp"
+#include <thread>
+
+using namespace ULCommonUtils;
+using namespace ULCommonUtils::Benchmark;
+
+namespace
+{
+	const char* Config = R"({"service":{"http":{"port":8080,"timeout":30,"workers":16},"db":{"host":"db1","pool":8}},"limits":{"rate":1000}})";
+
+	//Runs background readers on every thread but the measuring one, and a writer replacing the tree every few
+	//milliseconds, while the measuring thread times its own reads
+	template<typename MakeReader, typename Write>
+	void runContended(Runner& runner, const std::string& name, size_t threads, MakeReader makeReader, Write write)
+	{
+		std::atomic<bool> stop(false);
+		std::vector<stdThread> background;
+		for (size_t i = 1; i < threads; i++)
+		{
+			background.emplace_back([&stop, makeReader]()
+			{
+				auto reader = makeReader();
+				while (!stop.load(std::memory_order_relaxed))
+					doNotOptimize(reader());
+			});
+		}
+
+		background.emplace_back([&stop, write]() mutable
+		{
+			for (int i = 0; !stop.load(std::memory_order_relaxed); i++)
+			{
+				write(i);
+				std::this_thread::sleep_for(std::chrono::milliseconds(5));
+			}
+		});
+
+		auto reader = makeReader();
+		runner.run(name, 0, 1000, [&reader]()
+		{
+			doNotOptimize(reader());
+		});
+
+		stop = true;
+		for (auto& thread : background)
+			thread.join();
+	}
+
+	//Read latency of a shared configuration tree per reading thread, as readers are added. Aggregate throughput is
+	//threads / mean_ns.
+	void concurrentSuite(Runner& runner)
+	{
+		if (!runner.selected("concurrent_"))
+			return;
+
+		const JSonPropertyTree config = deseraliseFromJSon(Config);
+		const JSonPropertyTree::CompiledPath port(JSonPropertyTree::Path{ "service", "http", "port" });
+		size_t cores = std::max<size_t>(1, std::thread::hardware_concurrency());
+		for (size_t threads = 1;; threads = std::min(2 * threads, cores))
+		{
+			auto suffix = "/threads" + std::to_string(threads);
+
+			ConcurrentTree<> store(config);
+			runContended(runner, "concurrent_read/rcu" + suffix, threads, [&store, &port]()
+			{
+				return [reader = store.reader(), &port]() mutable
+				{
+					auto snapshot = reader.read();
+					return *snapshot->try_get<int>(port);
+				};
+			},
+			[&store](int i)
+			{
+				store.update([i](JSonPropertyTree& pt) { pt[JSonPropertyTree::Path{ "limits", "rate" }] = i; });
+			});
+
+			JSonPropertyTree guarded(config);
+			stdMutex mutex;
+			runContended(runner, "concurrent_read/mutex" + suffix, threads, [&guarded, &mutex, &port]()
+			{
+				return [&guarded, &mutex, &port]()
+				{
+					stdUniqueLock lock(mutex);
+					return *guarded.try_get<int>(port);
+				};
+			},
+			[&guarded, &mutex](int i)
+			{
+				stdUniqueLock lock(mutex);
+				guarded[JSonPropertyTree::Path{ "limits", "rate" }] = i;
+			});
+
+			if (threads == cores)
+				break;
+		}
+	}
+
+	SuiteRegistrar concurrent("concurrent", concurrentSuite);
+}
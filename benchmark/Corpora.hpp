@@ -0,0 +1,191 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ULCommonUtils
+{
+	namespace Benchmark
+	{
+		//Deterministic pseudo random numbers, identical on every platform unlike the <random> distributions
+		class SplitMix64
+		{
+			uint64_t m_state;
+
+		public:
+			SplitMix64(uint64_t seed) : m_state(seed) {}
+
+			uint64_t next()
+			{
+				uint64_t z = (m_state += 0x9e3779b97f4a7c15ULL);
+				z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+				z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+				return z ^ (z >> 31);
+			}
+
+			uint64_t below(uint64_t bound)
+			{
+				return next() % bound;
+			}
+		};
+
+		struct Corpus
+		{
+			std::string m_name;
+			std::string m_json;
+		};
+
+		//{"level":0,"child":{"level":1,"items":[{"level":2,"child":...}]}} alternating objects and arrays
+		inline std::string deepNesting(size_t depth)
+		{
+			std::string json;
+			for (size_t level = 0; level < depth; level++)
+			{
+				json += "{\"level\":" + std::to_string(level) + ",\"tag\":\"n" + std::to_string(level) + "\",";
+				json += (0 == level % 2) ? "\"child\":" : "\"items\":[1,";
+			}
+
+			json += "{\"leaf\":1}";
+			for (size_t level = depth; level-- > 0;)
+				json += (0 == level % 2) ? "}" : "]}";
+
+			return json;
+		}
+
+		//One object with many members of every scalar type
+		inline std::string wideObject(size_t members)
+		{
+			SplitMix64 rng(1);
+			std::string json = "{";
+			for (size_t i = 0; i < members; i++)
+			{
+				if (0 != i)
+					json += ",";
+
+				json += "\"member" + std::to_string(i) + "\":";
+				switch (i % 4)
+				{
+				case 0:
+					json += std::to_string(rng.below(1000000));
+					break;
+				case 1:
+					json += std::to_string(rng.below(1000000)) + "." + std::to_string(rng.below(1000));
+					break;
+				case 2:
+					json += "\"value" + std::to_string(rng.below(100000)) + "\"";
+					break;
+				default:
+					json += "'" + std::string(1, static_cast<char>('A' + rng.below(26))) + "'";
+					break;
+				}
+			}
+
+			return json + "}";
+		}
+
+		//Integer and floating point arrays of the given length each
+		inline std::string numericArrays(size_t length)
+		{
+			SplitMix64 rng(2);
+			std::string json = "{\"ints\":[";
+			for (size_t i = 0; i < length; i++)
+				json += ((0 == i) ? "" : ",") + std::to_string(static_cast<int64_t>(rng.next() >> 20) - (1LL << 42));
+
+			json += "],\"doubles\":[";
+			for (size_t i = 0; i < length; i++)
+				json += ((0 == i) ? "" : ",") + std::to_string(rng.below(100000000)) + "." + std::to_string(rng.below(1000000)) + "e-" + std::to_string(rng.below(10));
+
+			return json + "]}";
+		}
+
+		//A few members holding long strings with the odd escape sequence
+		inline std::string longStrings(size_t count, size_t length)
+		{
+			SplitMix64 rng(3);
+			std::string json = "{";
+			for (size_t i = 0; i < count; i++)
+			{
+				json += ((0 == i) ? "\"text" : ",\"text") + std::to_string(i) + "\":\"";
+				for (size_t pos = 0; pos < length; pos++)
+				{
+					auto r = rng.below(64);
+					if (0 == r)
+						json += "\\\"";
+					else if (1 == r)
+						json += "\\n";
+					else
+					{
+						auto ch = static_cast<char>(' ' + rng.below(95));
+						json += (('\"' == ch) || ('\\' == ch)) ? '_' : ch;
+					}
+				}
+
+				json += "\"";
+			}
+
+			return json + "}";
+		}
+
+		//Strings made mostly of escaped quotes, runs of escaped backslashes and structural characters, in keys and values of
+		//lengths that put every kind of escape across the 64 byte blocks of the structural index
+		inline std::string escapedStrings(size_t count)
+		{
+			static const char* pieces[] = { "\\\"", "\\\\", "\\\\\\\"", "\\\\\\\\", "{", "}", "[", "]", ",", ":", "'", "x" };
+			SplitMix64 rng(5);
+			auto text = [&rng](size_t pieceCount)
+			{
+				std::string str;
+				for (size_t i = 0; i < pieceCount; i++)
+					str += pieces[rng.below(12)];
+
+				return str;
+			};
+
+			std::string json = "{";
+			for (size_t i = 0; i < count; i++)
+			{
+				json += ((0 == i) ? "\"" : ",\"") + text(i % 7) + std::to_string(i) + "\":";
+				json += (0 == i % 3) ? "[\"" + text(i % 97) + "\",\"" + text(64) + "\"]" : "\"" + text(i % 131) + "\"";
+			}
+
+			return json + "}";
+		}
+
+		//Many small objects sharing one schema, the typical shape of market data and order messages
+		inline std::string repeatedSchema(size_t records)
+		{
+			SplitMix64 rng(4);
+			static const char* symbols[] = { "AAPL", "MSFT", "GOOG", "AMZN", "TSLA", "NVDA", "META", "INTC" };
+			std::string json = "{\"orders\":[";
+			for (size_t i = 0; i < records; i++)
+			{
+				json += (0 == i) ? "{" : ",{";
+				json += "\"id\":" + std::to_string(1000000 + i);
+				json += ",\"sym\":\"" + std::string(symbols[rng.below(8)]) + "\"";
+				json += ",\"side\":'" + std::string(1, (0 == rng.below(2)) ? 'B' : 'S') + "'";
+				json += ",\"px\":" + std::to_string(100 + rng.below(900)) + "." + std::to_string(rng.below(100));
+				json += ",\"qty\":" + std::to_string(1 + rng.below(10000));
+				json += ",\"venue\":\"X" + std::to_string(rng.below(16)) + "\"}";
+			}
+
+			return json + "]}";
+		}
+
+		//Array of repeatedSchema shaped records sized to roughly the given number of bytes, for checking linear scaling
+		inline std::string sizedDocument(size_t bytes)
+		{
+			return repeatedSchema(bytes / 75 + 1);
+		}
+
+		inline std::vector<Corpus> standardCorpora()
+		{
+			return {
+				{ "deep_nesting", deepNesting(128) },
+				{ "wide_object", wideObject(2000) },
+				{ "numeric_arrays", numericArrays(4000) },
+				{ "long_strings", longStrings(8, 16384) },
+				{ "repeated_schema", repeatedSchema(1000) }
+			};
+		}
+	}
+}
@@ -0,0 +1,87 @@
+#include "Benchmark.hpp"
+#include "CommonUtils/PersistentTree.hpp"
+#include "CommonUtils/TreeDiff.hpp"
+
+using namespace ULCommonUtils;
+using namespace ULCommonUtils::Benchmark;
+
+namespace
+{
+	//{"record0":{"field0":0, ..., "field9":9}, ..., "record4999":{...}}
+	template<typename Tree>
+	Tree recordTree(size_t records)
+	{
+		Tree pt;
+		for (size_t i = 0; i < records; i++)
+		{
+			Tree record;
+			for (int j = 0; j < 10; j++)
+				record["field" + std::to_string(j)] = j;
+
+			pt["record" + std::to_string(i)] = std::move(record);
+		}
+
+		return pt;
+	}
+
+	//A change made through a reference taken before the digests were cached leaves the digests of the ancestors stale,
+	//diff() still has to find it
+	template<typename Tree>
+	void checkStaleDigests(Runner& runner, const std::string& policy)
+	{
+		Tree from;
+		from[typename Tree::Path{ "x", "y", "z" }] = 1;
+		Tree to = from;
+		auto& y = *to.template try_get<Tree>(typename Tree::Path{ "x", "y" });
+		from.digest();
+		to.digest();
+		y["z"] = 2;
+
+		auto patch = diff(from, to);
+		Tree patched = from;
+		applyPatch(patched, patch);
+		runner.check("diff_stale_digest/" + policy, (1 == patch.size()) && (patched == to));
+	}
+
+	//Digesting and diffing two versions of a large tree differing in one leaf, with and without cached digests
+	template<typename Tree>
+	void diffBenchmarks(Runner& runner, const std::string& policy)
+	{
+		const size_t Records = 5000;
+		const Tree from = recordTree<Tree>(Records);
+		Tree to = from;
+		from.digest();
+		to.digest();
+
+		typename Tree::Path path{ "record" + std::to_string(Records / 2), "field5" };
+		int value = 0;
+		runner.run("diff_digest_after_change/" + policy, 0, 1, [&to, &path, &value]()
+		{
+			to[path] = ++value;
+			doNotOptimize(to.digest());
+		});
+
+		runner.run("diff_one_change/" + policy, 0, 1, [&from, &to]()
+		{
+			doNotOptimize(diff(from, to).size());
+		});
+
+		auto patch = diff(from, to);
+		Tree patched = from;
+		runner.run("diff_apply/" + policy, 0, 1, [&patched, &patch]()
+		{
+			applyPatch(patched, patch);
+		});
+	}
+
+	void diffSuite(Runner& runner)
+	{
+		checkStaleDigests<DigestPropertyTree>(runner, "cached");
+		checkStaleDigests<PersistentPropertyTree>(runner, "persistent");
+		diffBenchmarks<JSonPropertyTree>(runner, "plain");
+		diffBenchmarks<DigestPropertyTree>(runner, "cached");
+		diffBenchmarks<PersistentPropertyTree>(runner, "persistent");
+	}
+
+	SuiteRegistrar diffs("diff", diffSuite);
+}
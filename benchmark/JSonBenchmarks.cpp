@@ -0,0 +1,160 @@
+#include "Benchmark.hpp"
+#include "Corpora.hpp"
+#include "CommonUtils/PropertyTree.hpp"
+#include "CommonUtils/JSonStreamParser.hpp"
+#include "CommonUtils/JSonScanner.hpp"
+#include "CommonUtils/Arena.hpp"
+#include "CommonUtils/SmallMap.hpp"
+#include "CommonUtils/Atom.hpp"
+
+using namespace ULCommonUtils;
+using namespace ULCommonUtils::Benchmark;
+
+namespace
+{
+	//Feeding a document in chunks of any size builds the same tree as parsing it whole, strings and numbers cut by a
+	//chunk boundary included
+	void checkStreamChunks(Runner& runner, const Corpus& corpus, const JSonPropertyTree& expected)
+	{
+		for (size_t chunk : { 1, 2, 3, 7, 64, 4096 })
+		{
+			std::vector<JSonPropertyTree> trees;
+			PropertyTreeBuilder builder([&trees](JSonPropertyTree&& pt) { trees.push_back(std::move(pt)); });
+			JSonStreamParser<PropertyTreeBuilder> parser(builder);
+			for (size_t pos = 0; pos < corpus.m_json.length(); pos += chunk)
+				parser.feed(std::string_view(corpus.m_json).substr(pos, chunk));
+
+			runner.check("parse_stream_chunks/" + corpus.m_name + "/" + std::to_string(chunk), (1 == trees.size()) && (trees[0] == expected));
+		}
+	}
+
+	//Every structural scanner the cpu supports indexes a document so that it parses to the same tree as the cursor parser
+	void checkScanners(Runner& runner, const Corpus& corpus, const JSonPropertyTree& expected)
+	{
+		const std::pair<JSonScannerKind, const char*> kinds[] = { { JSonScannerKind::Scalar, "scalar" }, { JSonScannerKind::Sse42, "sse42" }, { JSonScannerKind::Avx2, "avx2" } };
+		for (auto& kind : kinds)
+		{
+			if (kind.first > activeJSonScanner())
+				continue;
+
+			JSonStructuralIndex index;
+			index.build(corpus.m_json, kind.first);
+			runner.check("parse_indexed_scanner/" + corpus.m_name + "/" + kind.second, deseraliseFromJSon(corpus.m_json, index) == expected);
+		}
+	}
+
+	void checkParsers(Runner& runner, const Corpus& corpus)
+	{
+		auto expected = deseraliseFromJSon(corpus.m_json);
+		checkStreamChunks(runner, corpus, expected);
+		checkScanners(runner, corpus, expected);
+	}
+
+	void jsonSuite(Runner& runner)
+	{
+		checkParsers(runner, Corpus{ "escaped_strings", escapedStrings(300) });
+		for (auto& corpus : standardCorpora())
+		{
+			auto& json = corpus.m_json;
+			checkParsers(runner, corpus);
+			runner.run("parse/" + corpus.m_name, json.length(), 1, [&json]()
+			{
+				auto pt = deseraliseFromJSon(json);
+				doNotOptimize(pt.size());
+			});
+
+			JSonStructuralIndex index;
+			runner.run("parse_indexed/" + corpus.m_name, json.length(), 1, [&json, &index]()
+			{
+				index.build(json);
+				auto pt = deseraliseFromJSon(json, index);
+				doNotOptimize(pt.size());
+			});
+
+			runner.run("parse_stream/" + corpus.m_name, json.length(), 1, [&json]()
+			{
+				size_t trees = 0;
+				PropertyTreeBuilder builder([&trees](JSonPropertyTree&&) { trees++; });
+				JSonStreamParser<PropertyTreeBuilder> parser(builder);
+				for (size_t pos = 0; pos < json.length(); pos += 4096)
+					parser.feed(std::string_view(json).substr(pos, 4096));
+
+				doNotOptimize(trees);
+			});
+
+			auto pt = deseraliseFromJSon(json);
+			std::string out;
+			serializeToJSon<NullVisitor>(pt, StringSink(out));
+			runner.run("serialize/" + corpus.m_name, out.length(), 1, [&pt, &out]()
+			{
+				out.clear();
+				serializeToJSon<NullVisitor>(pt, StringSink(out));
+				doNotOptimize(out.data());
+			});
+		}
+	}
+
+	//Throughput should stay flat as documents grow if parsing is linear in the input size
+	void scalingSuite(Runner& runner)
+	{
+		for (size_t bytes : { 1 << 10, 1 << 14, 1 << 18, 1 << 22 })
+		{
+			auto json = sizedDocument(bytes);
+			runner.run("parse_scaling/" + std::to_string(bytes), json.length(), 1, [&json]()
+			{
+				auto pt = deseraliseFromJSon(json);
+				doNotOptimize(pt.size());
+			});
+		}
+	}
+
+	template<typename Tree>
+	void sumOrders(const Tree& pt, const typename Tree::NodeContainer::key_type& orders, const typename Tree::NodeContainer::key_type& px, const typename Tree::NodeContainer::key_type& qty)
+	{
+		double total = 0;
+		for (auto& order : boost::get<typename Tree::Nodes>(pt[orders]))
+		{
+			auto& fields = boost::get<Tree>(order);
+			total += boost::get<double>(fields[px]) * boost::get<int>(fields[qty]);
+		}
+
+		doNotOptimize(total);
+	}
+
+	//The same repeated schema document under the available container policies and key types
+	template<typename Tree>
+	void policyBenchmarks(Runner& runner, const std::string& policy, const std::string& json)
+	{
+		runner.run("policy_parse/" + policy, json.length(), 1, [&json]()
+		{
+			auto pt = deseraliseFromJSon<Tree>(json);
+			doNotOptimize(pt.size());
+		});
+
+		auto pt = deseraliseFromJSon<Tree>(json);
+		typename Tree::NodeContainer::key_type orders("orders"), px("px"), qty("qty");
+		runner.run("policy_lookup/" + policy, 0, 1, [&pt, &orders, &px, &qty]()
+		{
+			sumOrders(pt, orders, px, qty);
+		});
+	}
+
+	void policySuite(Runner& runner)
+	{
+		auto json = repeatedSchema(1000);
+		policyBenchmarks<JSonPropertyTree>(runner, "hash", json);
+		policyBenchmarks<FlatPropertyTree>(runner, "flat", json);
+		policyBenchmarks<AtomPropertyTree>(runner, "atom", json);
+
+		runner.run("policy_parse/arena", json.length(), 1, [&json]()
+		{
+			ScopedArena arena;
+			auto pt = deseraliseFromJSon<ArenaPropertyTree>(json);
+			doNotOptimize(pt.size());
+		});
+	}
+
+	SuiteRegistrar json("json", jsonSuite);
+	SuiteRegistrar scaling("scaling", scalingSuite);
+	SuiteRegistrar policies("policies", policySuite);
+}
@@ -0,0 +1,49 @@
+#include "Benchmark.hpp"
+#include "Corpora.hpp"
+#include "CommonUtils/MappedJSonDocument.hpp"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+using namespace ULCommonUtils;
+using namespace ULCommonUtils::Benchmark;
+
+namespace
+{
+	//Reading one record out of a large file: mapping it lazily against parsing all of it
+	void lazySuite(Runner& runner)
+	{
+		if (!runner.selected("lazy_"))
+			return;
+
+		const size_t Records = 200000;
+		auto json = repeatedSchema(Records);
+		auto path = (std::filesystem::temp_directory_path() / "CommonUtilsBenchmark.json").string();
+		{
+			std::ofstream file(path, std::ios::binary);
+			file.write(json.data(), json.length());
+		}
+
+		runner.run("lazy_open_and_find/mapped", json.length(), 1, [&path]()
+		{
+			MappedJSonDocument document(path);
+			doNotOptimize(document.find_path({ "orders" })->at(Records / 2)->find("px")->materialize());
+		});
+
+		runner.run("lazy_open_and_find/full_parse", json.length(), 1, [&json]()
+		{
+			auto pt = deseraliseFromJSon(json);
+			doNotOptimize(boost::get<JSonPropertyTree>(boost::get<JSonPropertyTree::Nodes>(pt["orders"])[Records / 2])["px"]);
+		});
+
+		MappedJSonDocument document(path);
+		runner.run("lazy_find/mapped", 0, 1, [&document]()
+		{
+			doNotOptimize(document.find_path({ "orders" })->at(Records / 2)->find("px")->materialize());
+		});
+
+		std::remove(path.c_str());
+	}
+
+	SuiteRegistrar lazy("lazy", lazySuite);
+}
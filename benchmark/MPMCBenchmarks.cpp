@@ -0,0 +1,157 @@
+#include "Benchmark.hpp"
+#include "CommonUtils/MPMCQueue.hpp"
+#include <thread>
+
+using namespace ULCommonUtils;
+using namespace ULCommonUtils::Benchmark;
+
+namespace
+{
+	const size_t Capacity = 1024;
+	const size_t MaxThreads = 32;
+	const uint64_t Stop = ~uint64_t(0);
+
+	//RingBuffer behind a mutex, the baseline of the suite
+	class LockedQueue
+	{
+		RingBuffer<uint64_t> m_queue;
+		stdMutex m_mutex;
+		stdConditionVariable m_notEmpty;
+		stdConditionVariable m_notFull;
+	public:
+		explicit LockedQueue(size_t capacity) : m_queue(capacity) {}
+
+		void push(uint64_t val)
+		{
+			stdUniqueLock lock(m_mutex);
+			m_notFull.wait(lock, [this]() { return !m_queue.full(); });
+			m_queue.push(val);
+			lock.unlock();
+			m_notEmpty.notify_one();
+		}
+
+		void pop(uint64_t& val)
+		{
+			stdUniqueLock lock(m_mutex);
+			m_notEmpty.wait(lock, [this]() { return !m_queue.empty(); });
+			val = m_queue.front();
+			m_queue.pop();
+			lock.unlock();
+			m_notFull.notify_one();
+		}
+	};
+
+	//The measuring thread is one of the producers, the others and the consumers run in the background until it is
+	//done. mean_ns is the time per push of one producer, aggregate throughput is producers / mean_ns.
+	template<typename Queue>
+	void runFanIn(Runner& runner, const std::string& name, size_t producers, size_t consumers)
+	{
+		Queue queue(Capacity);
+		std::atomic<bool> stop(false);
+		std::vector<stdThread> producerThreads, consumerThreads;
+		for (size_t i = 1; i < producers; i++)
+		{
+			producerThreads.emplace_back([&queue, &stop]()
+			{
+				for (uint64_t next = 0; !stop.load(std::memory_order_relaxed); next++)
+					queue.push(next);
+			});
+		}
+
+		for (size_t i = 0; i < consumers; i++)
+		{
+			consumerThreads.emplace_back([&queue]()
+			{
+				uint64_t sum = 0;
+				for (uint64_t val; queue.pop(val), Stop != val;)
+					sum += val;
+
+				doNotOptimize(sum);
+			});
+		}
+
+		uint64_t next = 0;
+		runner.run(name + "/p" + std::to_string(producers) + "c" + std::to_string(consumers), sizeof(uint64_t), 100, [&queue, &next]()
+		{
+			queue.push(next++);
+		});
+
+		stop = true;
+		for (auto& thread : producerThreads)
+			thread.join();
+
+		for (size_t i = 0; i < consumers; i++)
+			queue.push(Stop);
+
+		for (auto& thread : consumerThreads)
+			thread.join();
+	}
+
+	//Queues of every capacity below the smallest cell count fill up to capacity() and hand the elements back in order,
+	//also between two threads
+	void checkSmallCapacities(Runner& runner)
+	{
+		if (!runner.selected("mpmc_capacity/"))
+			return;
+
+		for (size_t capacity : { 0, 1, 2, 3 })
+		{
+			auto suffix = "/capacity" + std::to_string(capacity);
+			MPMCQueue<uint64_t> queue(capacity);
+			size_t pushed = 0;
+			while ((pushed <= queue.capacity()) && queue.try_push(pushed))
+				pushed++;
+
+			bool inOrder = true;
+			uint64_t val;
+			for (size_t i = 0; i < pushed; i++)
+				inOrder = inOrder && queue.try_pop(val) && (i == val);
+
+			runner.check("mpmc_capacity/fill" + suffix, (pushed == queue.capacity()) && (pushed >= std::max<size_t>(capacity, 1)) && inOrder && !queue.try_pop(val));
+
+			const uint64_t Count = 100000;
+			stdThread producer([&queue, Count]()
+			{
+				for (uint64_t next = 0; next < Count; next++)
+					queue.push(next);
+			});
+
+			for (uint64_t expected = 0; expected < Count; expected++)
+			{
+				queue.pop(val);
+				inOrder = inOrder && (expected == val);
+			}
+
+			producer.join();
+			runner.check("mpmc_capacity/transfer" + suffix, inOrder && !queue.try_pop(val));
+		}
+	}
+
+	//Producers and consumers from 1 to 32 each, one to one and fanning in to a single consumer, through the locked
+	//RingBuffer and through MPMCQueue with each wait strategy. Busy spinning is only run while every thread has a core
+	//of its own, beyond that spinning threads starve the ones they wait for.
+	void mpmcSuite(Runner& runner)
+	{
+		checkSmallCapacities(runner);
+		if (!runner.selected("mpmc_"))
+			return;
+
+		size_t cores = std::max<size_t>(1, std::thread::hardware_concurrency());
+		for (size_t producers = 1; producers <= MaxThreads; producers *= 2)
+		{
+			for (size_t consumers : { producers, size_t(1) })
+			{
+				runFanIn<LockedQueue>(runner, "mpmc_push/mutex", producers, consumers);
+				if (producers + consumers <= cores)
+					runFanIn<MPMCQueue<uint64_t, BusySpinWait>>(runner, "mpmc_push/spin", producers, consumers);
+
+				runFanIn<MPMCQueue<uint64_t, YieldingWait>>(runner, "mpmc_push/yield", producers, consumers);
+				runFanIn<MPMCQueue<uint64_t, BlockingWait>>(runner, "mpmc_push/block", producers, consumers);
+				if (1 == producers)
+					break;
+			}
+		}
+	}
+
+	SuiteRegistrar mpmc("mpmc", mpmcSuite);
+}
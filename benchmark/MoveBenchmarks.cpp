@@ -0,0 +1,125 @@
+#include "Benchmark.hpp"
+#include "Corpora.hpp"
+#include "CommonUtils/PropertyTree.hpp"
+
+using namespace ULCommonUtils;
+using namespace ULCommonUtils::Benchmark;
+
+namespace
+{
+	const size_t Orders = 1000;
+
+	size_t subtreeCopies = 0;
+
+	//Counts the trees and arrays copied, so that the checks below fail on any copy where a move was meant
+	struct CopyCountingTreePolicy : DefaultTreePolicy
+	{
+		struct NodeBase
+		{
+			NodeBase() {}
+
+			NodeBase(const NodeBase&)
+			{
+				subtreeCopies++;
+			}
+
+			NodeBase(NodeBase&&) noexcept {}
+
+			NodeBase& operator=(const NodeBase&)
+			{
+				subtreeCopies++;
+				return *this;
+			}
+
+			NodeBase& operator=(NodeBase&&) noexcept
+			{
+				return *this;
+			}
+		};
+	};
+
+	typedef BasicPropertyTree<CopyCountingTreePolicy, std::string, std::string, char, int, long long, size_t, double> CopyCountingTree;
+
+	template<typename Tree = JSonPropertyTree>
+	Tree makeOrder(int id)
+	{
+		Tree order;
+		order.try_emplace("id", id);
+		order.try_emplace("sym", std::string("INFY"));
+		order.try_emplace("px", 1520.5);
+		order.try_emplace("qty", 100);
+		return order;
+	}
+
+	//Building, growing and parsing the documents benchmarked below copies no subtree
+	void checkNoCopies(Runner& runner, const std::string& json)
+	{
+		subtreeCopies = 0;
+		{
+			CopyCountingTree::Nodes orders;
+			for (size_t i = 0; i < Orders; i++)
+				orders.emplace_back(makeOrder<CopyCountingTree>(static_cast<int>(i)));
+
+			CopyCountingTree pt;
+			pt.try_emplace("orders", std::move(orders));
+		}
+
+		runner.check("moves_build/no_copies", 0 == subtreeCopies);
+
+		subtreeCopies = 0;
+		deseraliseFromJSon<CopyCountingTree>(json);
+		runner.check("moves_parse/no_copies", 0 == subtreeCopies);
+	}
+
+	//Building a document out of subtrees made elsewhere, and growing arrays of them, by moving against by copying.
+	//allocs_per_op is the figure to watch: moving costs no allocation per node once the subtree exists.
+	void moveSuite(Runner& runner)
+	{
+		auto json = repeatedSchema(Orders);
+		checkNoCopies(runner, json);
+
+		runner.run("moves_build/move", 0, 1, []()
+		{
+			JSonPropertyTree::Nodes orders;
+			for (size_t i = 0; i < Orders; i++)
+				orders.emplace_back(makeOrder(static_cast<int>(i)));
+
+			JSonPropertyTree pt;
+			pt.try_emplace("orders", std::move(orders));
+			doNotOptimize(pt.size());
+		});
+
+		runner.run("moves_build/copy", 0, 1, []()
+		{
+			JSonPropertyTree::Nodes orders;
+			for (size_t i = 0; i < Orders; i++)
+			{
+				const auto order = makeOrder(static_cast<int>(i));
+				orders.push_back(JSonPropertyTree::Node(order));
+			}
+
+			JSonPropertyTree pt;
+			const auto& constOrders = orders;
+			pt["orders"] = constOrders;
+			doNotOptimize(pt.size());
+		});
+
+		//Growth without reserve relocates every subtree built so far, which copied each of them before moves were noexcept
+		auto order = makeOrder(0);
+		runner.run("moves_grow/array", 0, 1, [&order]()
+		{
+			JSonPropertyTree::Nodes orders;
+			for (size_t i = 0; i < Orders; i++)
+				orders.push_back(JSonPropertyTree::Node(order));
+
+			doNotOptimize(orders.size());
+		});
+
+		runner.run("moves_parse/nested", json.length(), 1, [&json]()
+		{
+			doNotOptimize(deseraliseFromJSon(json).size());
+		});
+	}
+
+	SuiteRegistrar moves("moves", moveSuite);
+}
@@ -0,0 +1,99 @@
+#include "Benchmark.hpp"
+#include "Corpora.hpp"
+#include "CommonUtils/PropertyTree.hpp"
+
+using namespace ULCommonUtils;
+using namespace ULCommonUtils::Benchmark;
+
+namespace
+{
+	//Sums every number of a document, visiting each node once
+	template<typename Tree>
+	struct NumberSum
+	{
+		double& m_sum;
+
+		void operator()(const Tree& pt) const
+		{
+			for (auto it = pt.begin(); it != pt.end(); it++)
+				visitNode(*this, it->second);
+		}
+
+		void operator()(const typename Tree::Nodes& nodes) const
+		{
+			for (auto it = nodes.begin(); it != nodes.end(); it++)
+				visitNode(*this, *it);
+		}
+
+		void operator()(const std::string&) const {}
+		void operator()(char) const {}
+
+		template<typename Number>
+		void operator()(Number num) const
+		{
+			m_sum += static_cast<double>(num);
+		}
+	};
+
+	//Type tests that mostly fail, as made by code probing a member for each of the types it may hold
+	template<typename Tree>
+	size_t countTrees(const Tree& pt)
+	{
+		size_t count = 0;
+		for (auto it = pt.begin(); it != pt.end(); it++)
+		{
+			if (auto tree = getIf<Tree>(&it->second))
+				count += 1 + countTrees(*tree);
+			else if (auto nodes = getIf<typename Tree::Nodes>(&it->second))
+			{
+				for (auto elem = nodes->begin(); elem != nodes->end(); elem++)
+				{
+					if (auto subtree = getIf<Tree>(&*elem))
+						count += 1 + countTrees(*subtree);
+				}
+			}
+		}
+
+		return count;
+	}
+
+	template<typename Tree>
+	void runNodes(Runner& runner, const std::string& json, const char* variant)
+	{
+		std::string suffix = std::string("/") + variant;
+		runner.run("nodes_parse" + suffix, json.length(), 1, [&json]()
+		{
+			doNotOptimize(deseraliseFromJSon<Tree>(json).size());
+		});
+
+		//alloc_bytes_per_op is the heap footprint of the document
+		auto pt = deseraliseFromJSon<Tree>(json);
+		runner.run("nodes_copy" + suffix, json.length(), 1, [&pt]()
+		{
+			Tree copy(pt);
+			doNotOptimize(copy.size());
+		});
+
+		runner.run("nodes_traverse" + suffix, json.length(), 1, [&pt]()
+		{
+			double sum = 0;
+			NumberSum<Tree>{ sum }(pt);
+			doNotOptimize(sum);
+		});
+
+		runner.run("nodes_type_test" + suffix, json.length(), 1, [&pt]()
+		{
+			doNotOptimize(countTrees(pt));
+		});
+	}
+
+	//boost::variant nodes against std::variant nodes over the same document
+	void nodeSuite(Runner& runner)
+	{
+		auto json = repeatedSchema(1000);
+		runNodes<JSonPropertyTree>(runner, json, "boost");
+		runNodes<StdJSonPropertyTree>(runner, json, "std");
+	}
+
+	SuiteRegistrar nodes("nodes", nodeSuite);
+}
@@ -0,0 +1,55 @@
+#include "Benchmark.hpp"
+#include "Corpora.hpp"
+#include "CommonUtils/ParallelJSon.hpp"
+#include <thread>
+
+using namespace ULCommonUtils;
+using namespace ULCommonUtils::Benchmark;
+
+namespace
+{
+	//Bulk parsing of about 64MB of records as NDJSon and as one large array, from one thread up to every core
+	void parallelSuite(Runner& runner)
+	{
+		if (!runner.selected("parallel_"))
+			return;
+
+		auto document = sizedDocument(64 << 20);
+		auto array = document.substr(document.find('['), document.rfind(']') - document.find('[') + 1);
+		std::string ndjson;
+		ndjson.reserve(array.length());
+		for (size_t pos = 1; pos < array.length(); pos++)
+		{
+			if ((',' == array[pos]) && ('}' == array[pos - 1]))
+				ndjson += '\n';
+			else if (pos + 1 < array.length())
+				ndjson += array[pos];
+		}
+
+		runner.run("parallel_array/sequential", array.length(), 1, [&document]()
+		{
+			doNotOptimize(deseraliseFromJSon(document).size());
+		});
+
+		size_t cores = std::max<size_t>(1, std::thread::hardware_concurrency());
+		for (size_t threads = 1;; threads = std::min(2 * threads, cores))
+		{
+			ThreadPool pool(threads);
+			auto suffix = "/threads" + std::to_string(threads);
+			runner.run("parallel_array" + suffix, array.length(), 1, [&array, &pool]()
+			{
+				doNotOptimize(deseraliseArrayFromJSon(array, pool).size());
+			});
+
+			runner.run("parallel_ndjson" + suffix, ndjson.length(), 1, [&ndjson, &pool]()
+			{
+				doNotOptimize(deseraliseFromNDJSon(ndjson, pool).size());
+			});
+
+			if (threads == cores)
+				break;
+		}
+	}
+
+	SuiteRegistrar parallel("parallel", parallelSuite);
+}
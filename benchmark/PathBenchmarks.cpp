@@ -0,0 +1,82 @@
+#include "Benchmark.hpp"
+#include "CommonUtils/SmallMap.hpp"
+#include <stdexcept>
+
+using namespace ULCommonUtils;
+using namespace ULCommonUtils::Benchmark;
+
+namespace
+{
+	//Eight levels of {"field0":0, ..., "field15":15, "next":{...}}, wide enough for flat trees to index their members
+	//instead of searching them linearly
+	template<typename Tree>
+	Tree nestedTree(size_t depth)
+	{
+		Tree pt;
+		for (int i = 0; i < 16; i++)
+			pt["field" + std::to_string(i)] = i;
+
+		if (depth > 1)
+			pt["next"] = nestedTree<Tree>(depth - 1);
+
+		return pt;
+	}
+
+	//Compiled paths only save hashing with maps looking keys up by a hash computed beforehand, as the flat policy does
+	template<typename Tree>
+	void pathBenchmarks(Runner& runner, const std::string& policy)
+	{
+		const size_t Batch = 1000;
+		const Tree pt = nestedTree<Tree>(8);
+		for (size_t depth = 1; depth <= 8; depth++)
+		{
+			typename Tree::Path hit(depth - 1, "next"), miss(depth - 1, "next");
+			hit.push_back("field11");
+			miss.push_back("absent");
+			typename Tree::CompiledPath compiledHit(hit), compiledMiss(miss);
+			auto suffix = "/" + policy + "/depth" + std::to_string(depth);
+
+			runner.run("path_operator_hit" + suffix, 0, Batch, [&pt, &hit]()
+			{
+				doNotOptimize(&pt[hit]);
+			});
+
+			runner.run("path_operator_miss" + suffix, 0, Batch, [&pt, &miss]()
+			{
+				try
+				{
+					doNotOptimize(&pt[miss]);
+				}
+				catch (const std::runtime_error&) {}
+			});
+
+			runner.run("path_find_hit" + suffix, 0, Batch, [&pt, &hit]()
+			{
+				doNotOptimize(pt.template try_get<int>(hit));
+			});
+
+			runner.run("path_find_miss" + suffix, 0, Batch, [&pt, &miss]()
+			{
+				doNotOptimize(pt.template try_get<int>(miss));
+			});
+
+			runner.run("path_compiled_hit" + suffix, 0, Batch, [&pt, &compiledHit]()
+			{
+				doNotOptimize(pt.template try_get<int>(compiledHit));
+			});
+
+			runner.run("path_compiled_miss" + suffix, 0, Batch, [&pt, &compiledMiss]()
+			{
+				doNotOptimize(pt.template try_get<int>(compiledMiss));
+			});
+		}
+	}
+
+	void pathSuite(Runner& runner)
+	{
+		pathBenchmarks<JSonPropertyTree>(runner, "plain");
+		pathBenchmarks<FlatPropertyTree>(runner, "flat");
+	}
+
+	SuiteRegistrar paths("paths", pathSuite);
+}
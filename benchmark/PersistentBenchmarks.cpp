@@ -0,0 +1,80 @@
+#include "Benchmark.hpp"
+#include "CommonUtils/PersistentTree.hpp"
+
+using namespace ULCommonUtils;
+using namespace ULCommonUtils::Benchmark;
+
+namespace
+{
+	//{"group0":{"record0":{"field0":0, ..., "field4":4}, ..., "record99":{...}}, ..., "group99":{...}}
+	std::string groupedRecords(size_t groups, size_t records)
+	{
+		std::string json = "{";
+		for (size_t i = 0; i < groups; i++)
+		{
+			json += ((0 == i) ? "\"group" : ",\"group") + std::to_string(i) + "\":{";
+			for (size_t j = 0; j < records; j++)
+			{
+				json += ((0 == j) ? "\"record" : ",\"record") + std::to_string(j) + "\":{";
+				for (int k = 0; k < 5; k++)
+					json += ((0 == k) ? "\"field" : ",\"field") + std::to_string(k) + "\":" + std::to_string(k);
+
+				json += "}";
+			}
+
+			json += "}";
+		}
+
+		return json + "}";
+	}
+
+	//Handing a snapshot of a large tree to a reader, then changing one leaf of the writer's copy
+	template<typename Tree>
+	void snapshotBenchmarks(Runner& runner, const std::string& policy, const std::string& json)
+	{
+		Tree pt = deseraliseFromJSon<Tree>(json);
+		runner.run("snapshot_copy/" + policy, 0, 1, [&pt]()
+		{
+			Tree snapshot(pt);
+			doNotOptimize(snapshot.size());
+		});
+
+		typename Tree::Path path{ "group50", "record50", "field2" };
+		int value = 0;
+		runner.run("snapshot_copy_and_change/" + policy, 0, 1, [&pt, &path, &value]()
+		{
+			Tree snapshot(pt);
+			pt[path] = ++value;
+			doNotOptimize(snapshot.size());
+		});
+	}
+
+	//Snapshots and the subtrees a change copies out of them keep their cached digests, so that the digest of a new
+	//version only hashes the path that changed
+	void checkDigestsKept(Runner& runner, const std::string& json)
+	{
+		PersistentPropertyTree pt = deseraliseFromJSon<PersistentPropertyTree>(json);
+		pt.digest();
+
+		PersistentPropertyTree snapshot(pt);
+		runner.check("snapshot_digest/copy", snapshot.hasCachedDigest());
+
+		pt[PersistentPropertyTree::Path{ "group50", "record50", "field2" }] = -1;
+		auto sibling = pt.try_get<PersistentPropertyTree>("group51");
+		runner.check("snapshot_digest/sibling", sibling && sibling->hasCachedDigest());
+
+		auto nested = pt.try_get<PersistentPropertyTree>(PersistentPropertyTree::Path{ "group50", "record51" });
+		runner.check("snapshot_digest/nested_sibling", nested && nested->hasCachedDigest());
+		runner.check("snapshot_digest/changed", !pt.hasCachedDigest() && snapshot.hasCachedDigest());
+	}
+
+	void snapshotSuite(Runner& runner)
+	{
+		auto json = groupedRecords(100, 100);
+		checkDigestsKept(runner, json);
+		snapshotBenchmarks<JSonPropertyTree>(runner, "plain", json);
+		snapshotBenchmarks<PersistentPropertyTree>(runner, "persistent", json);
+	}
+
+	SuiteRegistrar snapshots("snapshot", snapshotSuite);
+}
@@ -0,0 +1,112 @@
+#include "Benchmark.hpp"
+#include "Corpora.hpp"
+#include "CommonUtils/TreeQuery.hpp"
+
+using namespace ULCommonUtils;
+using namespace ULCommonUtils::Benchmark;
+
+namespace
+{
+	typedef JSonPropertyTree::Node Node;
+	typedef JSonPropertyTree::Nodes Nodes;
+
+	//Hand written equivalent of $..id
+	void collectIds(const JSonPropertyTree& pt, std::vector<const Node*>& matches)
+	{
+		for (auto it = pt.begin(); it != pt.end(); it++)
+		{
+			if (it->first == "id")
+				matches.push_back(&it->second);
+
+			if (auto tree = boost::get<JSonPropertyTree>(&it->second))
+				collectIds(*tree, matches);
+			else if (auto nodes = boost::get<Nodes>(&it->second))
+			{
+				for (auto& elem : *nodes)
+				{
+					if (auto subtree = boost::get<JSonPropertyTree>(&elem))
+						collectIds(*subtree, matches);
+				}
+			}
+		}
+	}
+
+	//Queries compiled once and run against a tree, against the loops they replace
+	void querySuite(Runner& runner)
+	{
+		auto json = repeatedSchema(1000);
+		const auto pt = deseraliseFromJSon(json);
+
+		runner.run("query_compile", 0, 100, []()
+		{
+			doNotOptimize(TreeQuery<>("$.orders[?(@.qty > 5000)].px"));
+		});
+
+		TreeQuery<> wildcard("$.orders[*].px");
+		runner.run("query_wildcard/compiled", 0, 1, [&pt, &wildcard]()
+		{
+			doNotOptimize(wildcard.select(pt).size());
+		});
+
+		runner.run("query_wildcard/hand_written", 0, 1, [&pt]()
+		{
+			std::vector<const Node*> matches;
+			auto orders = pt.find("orders");
+			if (orders != pt.end())
+			{
+				if (auto nodes = boost::get<Nodes>(&orders->second))
+				{
+					for (auto& order : *nodes)
+					{
+						if (auto tree = boost::get<JSonPropertyTree>(&order))
+						{
+							auto px = tree->find("px");
+							if (px != tree->end())
+								matches.push_back(&px->second);
+						}
+					}
+				}
+			}
+
+			doNotOptimize(matches.size());
+		});
+
+		TreeQuery<> filter("$.orders[?(@.qty > 5000)].px");
+		runner.run("query_filter/compiled", 0, 1, [&pt, &filter]()
+		{
+			doNotOptimize(filter.select(pt).size());
+		});
+
+		runner.run("query_filter/hand_written", 0, 1, [&pt]()
+		{
+			std::vector<const Node*> matches;
+			for (auto& order : boost::get<Nodes>(pt.find("orders")->second))
+			{
+				if (auto tree = boost::get<JSonPropertyTree>(&order))
+				{
+					auto qty = tree->try_get<int>("qty");
+					auto px = tree->find("px");
+					if ((nullptr != qty) && (*qty > 5000) && (px != tree->end()))
+						matches.push_back(&px->second);
+				}
+			}
+
+			doNotOptimize(matches.size());
+		});
+
+		TreeQuery<> descendants("$..id");
+		runner.run("query_descendants/compiled", 0, 1, [&pt, &descendants]()
+		{
+			doNotOptimize(descendants.select(pt).size());
+		});
+
+		runner.run("query_descendants/hand_written", 0, 1, [&pt]()
+		{
+			std::vector<const Node*> matches;
+			collectIds(pt, matches);
+			doNotOptimize(matches.size());
+		});
+	}
+
+	SuiteRegistrar query("query", querySuite);
+}
@@ -0,0 +1,137 @@
+#include "Benchmark.hpp"
+#include "CommonUtils/RingBuffer.hpp"
+#include <array>
+#include <queue>
+
+using namespace ULCommonUtils;
+using namespace ULCommonUtils::Benchmark;
+
+namespace
+{
+	//RingBuffer as it was before it held its elements contiguously, the baseline of the suite
+	template <class T>
+	class QueueRingBuffer
+	{
+		std::queue<T> m_queue;
+		size_t m_capacity;
+	public:
+		QueueRingBuffer(size_t capacity) :
+			m_capacity(capacity)
+		{
+		}
+
+		void push(T item)
+		{
+			if (full())
+				pop();
+
+			m_queue.push(item);
+		}
+
+		void pop()
+		{
+			if (empty())
+				throw std::runtime_error("Trying to pop empty queue");
+
+			m_queue.pop();
+		}
+
+		size_t size()
+		{
+			return m_queue.size();
+		}
+
+		size_t empty()
+		{
+			return (size() == 0);
+		}
+
+		bool full()
+		{
+			return (size() == m_capacity);
+		}
+
+		T front()
+		{
+			if (empty())
+				throw std::runtime_error("Trying to access element when buffer is empty");
+
+			return m_queue.front();
+		}
+	};
+
+	struct Large
+	{
+		std::array<uint64_t, 32> m_words;
+
+		Large(uint64_t val = 0)
+		{
+			m_words.fill(val);
+		}
+	};
+
+	const size_t Capacity = 1024;
+	const size_t Batch = 1000;
+
+	uint64_t valueOf(uint64_t val)
+	{
+		return val;
+	}
+
+	uint64_t valueOf(const Large& val)
+	{
+		return val.m_words[0];
+	}
+
+	//Pushing to a full buffer, which drops the oldest element every time, and draining it again from the front
+	template<typename Buffer, typename T>
+	void runBuffer(Runner& runner, const std::string& name, Buffer& buffer)
+	{
+		for (size_t i = 0; i < Capacity; i++)
+			buffer.push(T(i));
+
+		uint64_t next = 0;
+		runner.run("ring_push_full/" + name, sizeof(T), Batch, [&buffer, &next]()
+		{
+			buffer.push(T(next++));
+		});
+
+		runner.run("ring_push_pop/" + name, sizeof(T), Batch, [&buffer, &next]()
+		{
+			buffer.push(T(next++));
+			doNotOptimize(valueOf(buffer.front()));
+			buffer.pop();
+		});
+	}
+
+	template<typename T>
+	void runElement(Runner& runner, const std::string& element)
+	{
+		QueueRingBuffer<T> queue(Capacity);
+		runBuffer<QueueRingBuffer<T>, T>(runner, element + "/queue", queue);
+
+		RingBuffer<T> contiguous(Capacity);
+		runBuffer<RingBuffer<T>, T>(runner, element + "/contiguous", contiguous);
+
+		auto inlined = std::make_unique<RingBuffer<T, Capacity>>();
+		runBuffer<RingBuffer<T, Capacity>, T>(runner, element + "/inline", *inlined);
+
+		runner.run("ring_iterate/" + element + "/contiguous", Capacity * sizeof(T), 1, [&contiguous]()
+		{
+			uint64_t sum = 0;
+			for (auto& item : contiguous)
+				sum += valueOf(item);
+
+			doNotOptimize(sum);
+		});
+	}
+
+	//Small and large elements in the former std::queue based buffer and in the contiguous one
+	void ringBufferSuite(Runner& runner)
+	{
+		runElement<uint64_t>(runner, "u64");
+		runElement<Large>(runner, "large256");
+	}
+
+	SuiteRegistrar ringBuffer("ring", ringBufferSuite);
+}
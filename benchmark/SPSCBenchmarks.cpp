@@ -0,0 +1,235 @@
+#include "Benchmark.hpp"
+#include "CommonUtils/SPSCRingBuffer.hpp"
+#include <array>
+#include <thread>
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+using namespace ULCommonUtils;
+using namespace ULCommonUtils::Benchmark;
+
+namespace
+{
+	const size_t Capacity = 1024;
+	const size_t Chunk = 16;
+	const uint64_t Stop = ~uint64_t(0);
+
+	const size_t All = ~size_t(0);
+
+	//Pins the calling thread to one core, or lets it run on all of them again when core is All. Best effort, the
+	//measurement still runs where pinning is not available.
+	void pin(size_t core)
+	{
+#ifdef __linux__
+		size_t cores = std::max(1u, std::thread::hardware_concurrency());
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		for (size_t i = 0; i < cores; i++)
+		{
+			if ((All == core) || (core % cores == i))
+				CPU_SET(i, &set);
+		}
+
+		pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+		(void)core;
+#endif
+	}
+
+	//Spins a while before giving up the core, so that two threads sharing a core still make progress
+	void backoff(size_t& spins)
+	{
+		if (++spins > 64)
+		{
+			spins = 0;
+			std::this_thread::yield();
+		}
+	}
+
+	//Handoff through the lock free queue
+	class SPSCChannel
+	{
+		SPSCRingBuffer<uint64_t> m_queue;
+	public:
+		SPSCChannel() : m_queue(Capacity) {}
+
+		void send(uint64_t val)
+		{
+			for (size_t spins = 0; !m_queue.try_push(val);)
+				backoff(spins);
+		}
+
+		void send(const uint64_t* vals, size_t count)
+		{
+			for (size_t spins = 0; count > 0;)
+			{
+				size_t pushed = m_queue.push_n(vals, count);
+				vals += pushed;
+				count -= pushed;
+				if (0 == pushed)
+					backoff(spins);
+			}
+		}
+
+		uint64_t receive()
+		{
+			uint64_t val;
+			for (size_t spins = 0; !m_queue.try_pop(val);)
+				backoff(spins);
+
+			return val;
+		}
+
+		size_t receive(uint64_t* vals, size_t count)
+		{
+			size_t popped;
+			for (size_t spins = 0; 0 == (popped = m_queue.pop_n(vals, count));)
+				backoff(spins);
+
+			return popped;
+		}
+	};
+
+	//Handoff through a RingBuffer guarded by a mutex, the baseline of the suite
+	class LockedChannel
+	{
+		RingBuffer<uint64_t> m_queue;
+		stdMutex m_mutex;
+		stdConditionVariable m_notEmpty;
+		stdConditionVariable m_notFull;
+	public:
+		LockedChannel() : m_queue(Capacity) {}
+
+		void send(uint64_t val)
+		{
+			stdUniqueLock lock(m_mutex);
+			m_notFull.wait(lock, [this]() { return !m_queue.full(); });
+			m_queue.push(val);
+			lock.unlock();
+			m_notEmpty.notify_one();
+		}
+
+		void send(const uint64_t* vals, size_t count)
+		{
+			for (size_t i = 0; i < count; i++)
+				send(vals[i]);
+		}
+
+		uint64_t receive()
+		{
+			stdUniqueLock lock(m_mutex);
+			m_notEmpty.wait(lock, [this]() { return !m_queue.empty(); });
+			uint64_t val = m_queue.front();
+			m_queue.pop();
+			lock.unlock();
+			m_notFull.notify_one();
+			return val;
+		}
+
+		size_t receive(uint64_t* vals, size_t count)
+		{
+			stdUniqueLock lock(m_mutex);
+			m_notEmpty.wait(lock, [this]() { return !m_queue.empty(); });
+			size_t popped = 0;
+			for (; (popped < count) && !m_queue.empty(); popped++)
+			{
+				vals[popped] = m_queue.front();
+				m_queue.pop();
+			}
+
+			lock.unlock();
+			m_notFull.notify_one();
+			return popped;
+		}
+	};
+
+	//The measuring thread produces, one message or one chunk of Chunk messages per operation, and a consumer pinned
+	//to another core drains until it receives Stop. mean_ns is the time per message for single sends and per chunk
+	//for chunked ones.
+	template<typename Channel>
+	void runThroughput(Runner& runner, const std::string& name)
+	{
+		auto channel = std::make_unique<Channel>();
+		stdThread consumer([&channel]()
+		{
+			pin(1);
+			std::array<uint64_t, Chunk> vals;
+			for (uint64_t sum = 0;;)
+			{
+				size_t count = channel->receive(vals.data(), Chunk);
+				for (size_t i = 0; i < count; i++)
+				{
+					if (Stop == vals[i])
+					{
+						doNotOptimize(sum);
+						return;
+					}
+
+					sum += vals[i];
+				}
+			}
+		});
+
+		pin(0);
+
+		uint64_t next = 0;
+		runner.run("spsc_throughput/single/" + name, sizeof(uint64_t), 1000, [&channel, &next]()
+		{
+			channel->send(next++);
+		});
+
+		std::array<uint64_t, Chunk> chunk;
+		runner.run("spsc_throughput/chunk" + std::to_string(Chunk) + "/" + name, Chunk * sizeof(uint64_t), 100, [&channel, &chunk, &next]()
+		{
+			for (auto& val : chunk)
+				val = next++;
+
+			channel->send(chunk.data(), Chunk);
+		});
+
+		channel->send(Stop);
+		consumer.join();
+	}
+
+	//Round trip of one message to an echoing thread on another core and back, one way latency is half of mean_ns
+	template<typename Channel>
+	void runLatency(Runner& runner, const std::string& name)
+	{
+		auto ping = std::make_unique<Channel>();
+		auto pong = std::make_unique<Channel>();
+		stdThread echo([&ping, &pong]()
+		{
+			pin(1);
+			for (uint64_t val; Stop != (val = ping->receive());)
+				pong->send(val);
+		});
+
+		pin(0);
+
+		uint64_t next = 0;
+		runner.run("spsc_round_trip/" + name, sizeof(uint64_t), 1, [&ping, &pong, &next]()
+		{
+			ping->send(next++);
+			doNotOptimize(pong->receive());
+		});
+
+		ping->send(Stop);
+		echo.join();
+	}
+
+	//Messages handed from one thread to another through the lock free queue and through a locked RingBuffer
+	void spscSuite(Runner& runner)
+	{
+		if (!runner.selected("spsc_"))
+			return;
+
+		runThroughput<SPSCChannel>(runner, "lockfree");
+		runThroughput<LockedChannel>(runner, "mutex");
+		runLatency<SPSCChannel>(runner, "lockfree");
+		runLatency<LockedChannel>(runner, "mutex");
+		pin(All);
+	}
+
+	SuiteRegistrar spsc("spsc", spscSuite);
+}
@@ -0,0 +1,169 @@
+#include "Benchmark.hpp"
+#include "CommonUtils/SharedRingBuffer.hpp"
+#include <thread>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+using namespace ULCommonUtils;
+using namespace ULCommonUtils::Benchmark;
+
+namespace
+{
+	struct Tick
+	{
+		uint64_t m_sequence;
+		uint32_t m_instrument;
+		uint32_t m_side;
+		double m_price;
+		double m_quantity;
+	};
+
+	const size_t Capacity = 1024;
+	const uint64_t Stop = ~uint64_t(0);
+
+	std::string segmentPath(const std::string& name)
+	{
+		std::string directory = (0 == ::access("/dev/shm", W_OK)) ? "/dev/shm" : "/tmp";
+		return directory + "/CommonUtilsBenchmark." + std::to_string(::getpid()) + "." + name;
+	}
+
+	template<typename Receive>
+	void waitFor(Receive receive)
+	{
+		for (size_t spins = 0; !receive(); spins++)
+		{
+			if (spins > 64)
+				std::this_thread::yield();
+		}
+	}
+
+	//Ticks sent to a child process echoing them back over a second ring
+	void runSharedRoundTrip(Runner& runner)
+	{
+		auto pingPath = segmentPath("ping"), pongPath = segmentPath("pong");
+		{
+			SharedRingWriter<Tick> ping(pingPath, Capacity);
+			SharedRingWriter<Tick> pong(pongPath, Capacity);
+		}
+
+		pid_t child = ::fork();
+		if (0 == child)
+		{
+			SharedRingReader<Tick> ping(pingPath);
+			SharedRingWriter<Tick> pong(pongPath, Capacity);
+			//Tells the parent that the child is reading
+			pong.push(Tick{});
+			for (Tick tick{};;)
+			{
+				waitFor([&ping, &tick]() { return SharedRingRead::Read == ping.try_read(tick); });
+				if (Stop == tick.m_sequence)
+					::_exit(0);
+
+				pong.push(tick);
+			}
+		}
+
+		SharedRingWriter<Tick> ping(pingPath, Capacity);
+		SharedRingReader<Tick> pong(pongPath, true);
+		Tick tick{};
+		waitFor([&pong, &tick]() { return SharedRingRead::Read == pong.try_read(tick); });
+
+		uint64_t next = 0;
+		runner.run("shm_round_trip/shared_ring", sizeof(Tick), 1, [&ping, &pong, &next]()
+		{
+			ping.push(Tick{ next++, 7, 1, 101.25, 300 });
+			Tick echoed{};
+			waitFor([&pong, &echoed]() { return SharedRingRead::Read == pong.try_read(echoed); });
+			doNotOptimize(echoed.m_sequence);
+		});
+
+		ping.push(Tick{ Stop, 0, 0, 0, 0 });
+		::waitpid(child, nullptr, 0);
+		::unlink(pingPath.c_str());
+		::unlink(pongPath.c_str());
+	}
+
+	//The same over a local socket, the baseline of the suite
+	void runSocketRoundTrip(Runner& runner)
+	{
+		int sockets[2];
+		if (-1 == ::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets))
+			return;
+
+		pid_t child = ::fork();
+		if (0 == child)
+		{
+			::close(sockets[0]);
+			for (Tick tick{}; (sizeof(Tick) == ::read(sockets[1], &tick, sizeof(Tick))) && (Stop != tick.m_sequence);)
+			{
+				if (sizeof(Tick) != ::write(sockets[1], &tick, sizeof(Tick)))
+					break;
+			}
+
+			::_exit(0);
+		}
+
+		::close(sockets[1]);
+		uint64_t next = 0;
+		int parent = sockets[0];
+		runner.run("shm_round_trip/socket", sizeof(Tick), 1, [parent, &next]()
+		{
+			Tick tick{ next++, 7, 1, 101.25, 300 };
+			if ((sizeof(Tick) != ::write(parent, &tick, sizeof(Tick))) || (sizeof(Tick) != ::read(parent, &tick, sizeof(Tick))))
+				throw std::runtime_error("Socket echo failed");
+
+			doNotOptimize(tick.m_sequence);
+		});
+
+		Tick stop{ Stop, 0, 0, 0, 0 };
+		if (sizeof(Tick) == ::write(parent, &stop, sizeof(Tick)))
+			::waitpid(child, nullptr, 0);
+
+		::close(parent);
+	}
+
+	//Publishing with no reader attached, and reading back a ring refilled whenever the reader has caught up
+	void runLocal(Runner& runner)
+	{
+		auto path = segmentPath("local");
+		{
+			SharedRingWriter<Tick> writer(path, Capacity);
+			SharedRingReader<Tick> reader(path);
+			uint64_t next = 0;
+			runner.run("shm_publish/shared_ring", sizeof(Tick), 1000, [&writer, &next]()
+			{
+				writer.push(Tick{ next++, 7, 1, 101.25, 300 });
+			});
+
+			runner.run("shm_read/shared_ring", sizeof(Tick), 1000, [&writer, &reader, &next]()
+			{
+				Tick tick{};
+				if (SharedRingRead::Read != reader.try_read(tick))
+				{
+					for (size_t i = 0; i < Capacity; i++)
+						writer.push(Tick{ next++, 7, 1, 101.25, 300 });
+
+					reader.catchUp();
+					reader.try_read(tick);
+				}
+
+				doNotOptimize(tick.m_sequence);
+			});
+		}
+
+		::unlink(path.c_str());
+	}
+
+	//Ticks handed between processes through a shared ring and through a local socket
+	void sharedRingSuite(Runner& runner)
+	{
+		if (!runner.selected("shm_"))
+			return;
+
+		runLocal(runner);
+		runSharedRoundTrip(runner);
+		runSocketRoundTrip(runner);
+	}
+
+	SuiteRegistrar sharedRing("shm", sharedRingSuite);
+}
@@ -0,0 +1,131 @@
+#include "Benchmark.hpp"
+#include "CommonUtils/SlidingWindow.hpp"
+#include <random>
+
+using namespace ULCommonUtils;
+using namespace ULCommonUtils::Benchmark;
+
+namespace
+{
+	struct Statistics
+	{
+		double m_min;
+		double m_max;
+		double m_sum;
+		double m_mean;
+		double m_variance;
+	};
+
+	//Every statistic recomputed over the whole RingBuffer on each tick, the baseline of the suite
+	Statistics recompute(const RingBuffer<double>& prices)
+	{
+		Statistics stats{ prices.front(), prices.front(), 0, 0, 0 };
+		for (double price : prices)
+		{
+			stats.m_min = std::min(stats.m_min, price);
+			stats.m_max = std::max(stats.m_max, price);
+			stats.m_sum += price;
+		}
+
+		stats.m_mean = stats.m_sum / prices.size();
+		for (double price : prices)
+			stats.m_variance += (price - stats.m_mean) * (price - stats.m_mean);
+
+		stats.m_variance /= prices.size();
+		return stats;
+	}
+
+	Statistics query(const SlidingWindow<double>& window)
+	{
+		return Statistics{ window.min(), window.max(), window.sum(), window.mean(), window.variance() };
+	}
+
+	//A random walk around start
+	class Prices
+	{
+		std::mt19937_64 m_random;
+		std::normal_distribution<double> m_step;
+		double m_price;
+	public:
+		Prices(double start = 100) : m_random(42), m_step(0, 0.01), m_price(start) {}
+
+		double next()
+		{
+			m_price += m_step(m_random);
+			return m_price;
+		}
+	};
+
+	bool near(double expected, double actual, double relativeTolerance)
+	{
+		return std::abs(expected - actual) <= relativeTolerance * std::abs(expected);
+	}
+
+	//The incremental statistics still match the ones recomputed from scratch after a long stream far from 0, where
+	//rounding errors of the updates would build up
+	void checkAgainstRecompute(Runner& runner)
+	{
+		if (!runner.selected("window_drift/"))
+			return;
+
+		const size_t Capacity = 1024;
+		Prices prices(1e6);
+		RingBuffer<double> buffer(Capacity);
+		SlidingWindow<double> window(Capacity);
+		for (size_t i = 0; i < 20000000; i++)
+		{
+			double price = prices.next();
+			buffer.push(price);
+			window.push(price);
+		}
+
+		auto expected = recompute(buffer);
+		auto actual = query(window);
+		runner.check("window_drift/min_max", (expected.m_min == actual.m_min) && (expected.m_max == actual.m_max));
+		runner.check("window_drift/sum_mean", near(expected.m_sum, actual.m_sum, 1e-12) && near(expected.m_mean, actual.m_mean, 1e-12));
+		runner.check("window_drift/variance", near(expected.m_variance, actual.m_variance, 1e-6));
+	}
+
+	//One tick per operation: a price pushed to a full window and every statistic read back
+	void windowSuite(Runner& runner)
+	{
+		checkAgainstRecompute(runner);
+		for (size_t capacity : { 64, 1024, 16384 })
+		{
+			auto suffix = "/window" + std::to_string(capacity);
+			Prices prices;
+
+			RingBuffer<double> buffer(capacity);
+			for (size_t i = 0; i < capacity; i++)
+				buffer.push(prices.next());
+
+			runner.run("window_tick/recompute" + suffix, sizeof(double), 10, [&buffer, &prices]()
+			{
+				buffer.push(prices.next());
+				doNotOptimize(recompute(buffer).m_variance);
+			});
+
+			SlidingWindow<double> window(capacity);
+			for (size_t i = 0; i < capacity; i++)
+				window.push(prices.next());
+
+			runner.run("window_tick/incremental" + suffix, sizeof(double), 1000, [&window, &prices]()
+			{
+				window.push(prices.next());
+				doNotOptimize(query(window).m_variance);
+			});
+
+			//A tick every millisecond in a window spanning a quarter of the capacity, so that most values leave by age
+			SlidingWindow<double> timed(std::chrono::milliseconds(capacity / 4), capacity);
+			time_point at;
+			runner.run("window_tick/timed" + suffix, sizeof(double), 1000, [&timed, &prices, &at]()
+			{
+				at += std::chrono::milliseconds(1);
+				timed.push(prices.next(), at);
+				doNotOptimize(query(timed).m_variance);
+			});
+		}
+	}
+
+	SuiteRegistrar window("window", windowSuite);
+}
@@ -0,0 +1,109 @@
+#include "Benchmark.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+
+namespace
+{
+	std::atomic<size_t> allocations(0);
+	std::atomic<size_t> bytes(0);
+
+	void* allocate(size_t size)
+	{
+		allocations.fetch_add(1, std::memory_order_relaxed);
+		bytes.fetch_add(size, std::memory_order_relaxed);
+		if (void* ptr = std::malloc((0 == size) ? 1 : size))
+			return ptr;
+
+		throw std::bad_alloc();
+	}
+
+	void printUsage(const char* program)
+	{
+		std::fprintf(stderr, "Usage: %s [--filter=<substring>] [--min-time=<seconds>] [--csv] [--check] [--list]\n", program);
+		std::fprintf(stderr, "Prints one JSon object (or CSV row) per benchmark on stdout, exits with 1 if a check failed\n");
+		std::fprintf(stderr, "--check runs the checks of the suites without the benchmarks\n");
+	}
+}
+
+void* operator new(size_t size)
+{
+	return allocate(size);
+}
+
+void* operator new[](size_t size)
+{
+	return allocate(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+	std::free(ptr);
+}
+
+size_t ULCommonUtils::Benchmark::allocationCount()
+{
+	return allocations.load(std::memory_order_relaxed);
+}
+
+size_t ULCommonUtils::Benchmark::allocatedBytes()
+{
+	return bytes.load(std::memory_order_relaxed);
+}
+
+int main(int argc, char** argv)
+{
+	using namespace ULCommonUtils::Benchmark;
+
+	Options options;
+	bool list = false;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg(argv[i]);
+		if (0 == arg.compare(0, 9, "--filter="))
+			options.m_filter = arg.substr(9);
+		else if (0 == arg.compare(0, 11, "--min-time="))
+			options.m_minSeconds = std::atof(arg.c_str() + 11);
+		else if ("--csv" == arg)
+			options.m_csv = true;
+		else if ("--check" == arg)
+			options.m_checkOnly = true;
+		else if ("--list" == arg)
+			list = true;
+		else
+		{
+			printUsage(argv[0]);
+			return ("--help" == arg) ? 0 : 1;
+		}
+	}
+
+	if (list)
+	{
+		for (auto& suite : suites())
+			std::printf("%s\n", suite.first);
+
+		return 0;
+	}
+
+	Runner runner(options);
+	for (auto& suite : suites())
+		suite.second(runner);
+
+	return (0 == runner.failures()) ? 0 : 1;
+}